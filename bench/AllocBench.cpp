@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "ilang/Type.hpp"
+
+using namespace ilang;
+
+namespace {
+	std::size_t numAllocs = 0;
+
+	struct LegacyType{
+		const LegacyType *base = nullptr;
+		std::string str, mangled;
+		std::vector<const LegacyType*> types;
+		std::vector<std::string> names;
+	};
+
+	struct Result{
+		std::size_t allocs;
+		double ms;
+	};
+
+	template<typename Fn>
+	Result measure(Fn &&fn){
+		auto allocs0 = numAllocs;
+		auto t0 = std::chrono::steady_clock::now();
+		fn();
+		auto t1 = std::chrono::steady_clock::now();
+		return {numAllocs - allocs0, std::chrono::duration<double, std::milli>(t1 - t0).count()};
+	}
+
+	void report(const char *name, std::size_t n, const Result &res){
+		std::printf("%-28s %10zu types %12zu allocs %8.2f allocs/type %10.2f ms\n", name, n, res.allocs, double(res.allocs) / n, res.ms);
+	}
+}
+
+void *operator new(std::size_t size){
+	++numAllocs;
+	if(auto p = std::malloc(size ? size : 1))
+		return p;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept{ std::free(p); }
+void operator delete(void *p, std::size_t) noexcept{ std::free(p); }
+
+int main(int argc, char *argv[]){
+	std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+	// node allocation only: the previous vector<unique_ptr<Type>> scheme against the arena
+	auto legacy = measure([n]{
+		std::vector<std::unique_ptr<LegacyType>> storage;
+		LegacyType elem;
+
+		for(std::size_t i = 0; i < n; i++){
+			auto type = std::make_unique<LegacyType>();
+			type->base = &elem;
+			type->types = {&elem};
+			storage.emplace_back(std::move(type));
+		}
+	});
+
+	auto arena = measure([n]{
+		std::vector<TypeHandle> storage;
+		TypeArena arena;
+		Type elem;
+		TypeHandle inner = &elem;
+
+		for(std::size_t i = 0; i < n; i++){
+			auto type = arena.create<Type>();
+			type->base = &elem;
+			type->types = arena.copy<TypeHandle>(&inner, &inner + 1);
+			storage.emplace_back(type);
+		}
+	});
+
+	// end-to-end creation through the public API
+	std::size_t typeBytes = 0, stringBytes = 0;
+
+	auto getters = measure([&]{
+		TypeData data;
+		auto i32 = getIntegerType(data, 32);
+
+		for(std::size_t i = 1; i <= n; i++)
+			getStaticArrayType(data, i32, i);
+
+		typeBytes = data.arena.bytesAllocated();
+		stringBytes = data.strings.bytesAllocated();
+	});
+
+	report("legacy make_unique nodes", n, legacy);
+	report("arena nodes", n, arena);
+	report("getStaticArrayType", n, getters);
+
+	std::printf("retained: %zu bytes of types, %zu bytes of names\n", typeBytes, stringBytes);
+}
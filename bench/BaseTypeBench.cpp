@@ -0,0 +1,80 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "ilang/Type.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! The base-chain walk hasBaseType used before refinement depths were recorded
+	bool walkHasBaseType(TypeHandle type, TypeHandle baseType) noexcept{
+		auto isInfinity = [](TypeHandle t){ return t->mangled == std::string_view("??"); };
+
+		if(isInfinity(baseType))
+			return true;
+
+		while(1){
+			if(type->base == baseType)
+				return true;
+			else if(isInfinity(type->base))
+				return false;
+			else
+				type = type->base;
+		}
+	}
+
+	//! The recursive findCommonType used before refinement depths were recorded
+	TypeHandle recursiveCommonType(TypeHandle type0, TypeHandle type1) noexcept{
+		if(type0 == type1 || walkHasBaseType(type1, type0)) return type0;
+		else if(walkHasBaseType(type0, type1)) return type1;
+		else return recursiveCommonType(type0->base, type1->base);
+	}
+
+	template<typename Fn>
+	void run(const char *name, std::size_t iters, const std::vector<std::pair<TypeHandle, TypeHandle>> &queries, Fn &&fn){
+		std::size_t hits = 0;
+
+		auto t0 = std::chrono::steady_clock::now();
+
+		for(std::size_t i = 0; i < iters; i++){
+			auto &&q = queries[i % queries.size()];
+			hits += fn(q.first, q.second);
+		}
+
+		auto t1 = std::chrono::steady_clock::now();
+		auto ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+		std::printf("%-26s %8.2f ns/op (%zu hits)\n", name, ns / iters, hits);
+	}
+}
+
+int main(int argc, char *argv[]){
+	std::size_t iters = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+	TypeData data;
+
+	auto bool8 = getBooleanType(data, 8);
+	auto nat8 = getNaturalType(data, 8);
+	auto int8 = getIntegerType(data, 8);
+	auto real16 = getRealType(data, 16);
+	auto arr = getStaticArrayType(data, bool8, 4);
+
+	// deep positive queries, deep negative queries and shallow queries
+	std::vector<std::pair<TypeHandle, TypeHandle>> queries = {
+		{bool8, data.numberType}, {bool8, data.complexType}, {bool8, data.integerType},
+		{nat8, data.realType}, {int8, data.rationalType},
+		{bool8, data.stringType}, {bool8, data.imaginaryType}, {int8, real16},
+		{arr, getListType(data, bool8)}, {arr, data.functionType},
+	};
+
+	run("base-chain walk", iters, queries, walkHasBaseType);
+	run("hasBaseType (handles)", iters, queries, [](TypeHandle a, TypeHandle b){ return hasBaseType(a, b); });
+	run("hasBaseType (ids)", iters, queries, [&data](TypeHandle a, TypeHandle b){ return hasBaseType(data, a->id, b->id); });
+
+	auto isNumber = [&data](TypeHandle t){ return t == data.numberType; };
+
+	run("recursive common type", iters, queries, [&](TypeHandle a, TypeHandle b){ return isNumber(recursiveCommonType(a, b)); });
+	run("findCommonType (handles)", iters, queries, [&](TypeHandle a, TypeHandle b){ return isNumber(findCommonType(a, b)); });
+	run("findCommonType (ids)", iters, queries, [&](TypeHandle a, TypeHandle b){ return isNumber(data.storage[findCommonType(data, a->id, b->id)]); });
+}
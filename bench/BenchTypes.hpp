@@ -0,0 +1,98 @@
+#ifndef ILANG_BENCH_BENCHTYPES_HPP
+#define ILANG_BENCH_BENCHTYPES_HPP 1
+
+#include <vector>
+
+#include "ilang/Type.hpp"
+
+namespace ilang::bench{
+	//! Which types \ref buildTypes makes
+	struct TypeMix{
+		//! Start from every root and sized family of the prelude instead of a few sized numbers
+		bool allLeaves = false;
+
+		//! Add a partial type to the leaves; partial types are only ever created fresh, never found by structure
+		bool partials = false;
+
+		//! Build trees, arrays and dynamic arrays as well as static arrays, lists, sums, products and functions
+		bool allKinds = false;
+
+		//! Only nest compound types in parenthesized ones, as display names are not nested otherwise, so every name parses back
+		bool parseable = false;
+
+		//! Finish with a sum, product and function of more inner types than the demangler keeps on the stack
+		bool wide = false;
+	};
+
+	/**
+	 * \brief Build \p n types (at least the leaves) of the kinds in \p mix
+	 *
+	 * Compound types are built from the leaves and the types built before them, so they nest several levels deep.
+	 **/
+	inline std::vector<TypeHandle> buildTypes(TypeData &data, std::size_t n, const TypeMix &mix = {}){
+		std::vector<TypeHandle> types = {
+			getIntegerType(data, 32), getNaturalType(data, 8), getRealType(data, 64),
+			getImaginaryType(data, 32), getStringType(data, StringEncoding::utf8), data.unitType
+		};
+
+		if(mix.allLeaves){
+			types.insert(end(types), {
+				data.infinityType, data.partialType, data.typeType, data.stringType,
+				data.numberType, data.complexType, data.imaginaryType, data.realType, data.rationalType,
+				data.integerType, data.naturalType, data.booleanType, data.functionType,
+				getStringType(data, StringEncoding::ascii), getBooleanType(data, 1),
+				getComplexType(data, 128), getRationalType(data, 64), getSumType(data)
+			});
+		}
+
+		if(mix.partials)
+			types.emplace_back(getPartialType(data));
+
+		static constexpr TypeKind someKinds[] = {
+			TypeKind::staticArray, TypeKind::list, TypeKind::sum, TypeKind::product, TypeKind::function
+		};
+
+		static constexpr TypeKind allKinds[] = {
+			TypeKind::tree, TypeKind::list, TypeKind::array, TypeKind::dynamicArray,
+			TypeKind::staticArray, TypeKind::sum, TypeKind::product, TypeKind::function
+		};
+
+		auto kinds = mix.allKinds ? allKinds : someKinds;
+		auto numKinds = mix.allKinds ? std::size(allKinds) : std::size(someKinds);
+
+		auto numLeaves = types.size();
+		auto numWide = mix.wide ? 3 : 0;
+
+		for(std::size_t i = 0; types.size() + numWide < n; i++){
+			auto a = types[i % numLeaves], b = types[(i * 7 + 1) % types.size()];
+
+			// sums, products and functions are not parenthesized, so their inner types must be leaves to parse back
+			auto c = mix.parseable ? types[(i + 1) % numLeaves] : b;
+
+			switch(kinds[i % numKinds]){
+				case TypeKind::tree: types.emplace_back(getTreeType(data, a)); break;
+				case TypeKind::list: types.emplace_back(getListType(data, b)); break;
+				case TypeKind::array: types.emplace_back(getArrayType(data, a)); break;
+				case TypeKind::dynamicArray: types.emplace_back(getDynamicArrayType(data, b)); break;
+				case TypeKind::staticArray: types.emplace_back(getStaticArrayType(data, a, i)); break;
+				case TypeKind::sum: types.emplace_back(getSumType(data, {a, c})); break;
+				case TypeKind::product: types.emplace_back(getProductType(data, {c, a})); break;
+				default: types.emplace_back(getFunctionType(data, {a, c}, a)); break;
+			}
+		}
+
+		if(mix.wide){
+			std::vector<TypeHandle> many;
+			for(std::uint32_t i = 1; i <= 40; i++)
+				many.emplace_back(getStaticArrayType(data, data.realType, i));
+
+			types.emplace_back(getSumType(data, many));
+			types.emplace_back(getProductType(data, many));
+			types.emplace_back(getFunctionType(data, many, data.unitType));
+		}
+
+		return types;
+	}
+}
+
+#endif // !ILANG_BENCH_BENCHTYPES_HPP
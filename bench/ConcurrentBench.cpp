@@ -0,0 +1,138 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "ilang/TypeCache.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Get one of \p numShapes compound types built from a handful of primitives, \p Data is a TypeData or TypeCache
+	template<typename Data>
+	TypeHandle getShape(Data &data, std::uint32_t shape){
+		auto prim = [&data](std::uint32_t i) -> TypeHandle{
+			switch(i % 6){
+				case 0: return getIntegerType(data, 8u << (i / 6 % 4));
+				case 1: return getNaturalType(data, 8u << (i / 6 % 4));
+				case 2: return getRealType(data, 16u << (i / 6 % 3));
+				case 3: return getBooleanType(data, 8);
+				case 4: return getStringType(data, StringEncoding::utf8);
+				default: return getBooleanType(data, 1);
+			}
+		};
+
+		auto a = prim(shape / 5), b = prim(shape / 5 + 1 + shape / 120);
+
+		switch(shape % 5){
+			case 0: return getFunctionType(data, {a, b}, a);
+			case 1: return getSumType(data, {a, b});
+			case 2: return getListType(data, a);
+			case 3: return getStaticArrayType(data, b, shape / 5 % 64);
+			default: return getProductType(data, {a, b, a});
+		}
+	}
+
+	/**
+	 * Run \p opsPerThread random shape lookups on each of \p numThreads threads, returning Mops/s.
+	 * \p makeWorker is called with the index of each thread to get its lookup function.
+	 **/
+	template<typename MakeWorker>
+	double run(std::size_t numThreads, std::size_t opsPerThread, std::uint32_t numShapes, MakeWorker &&makeWorker){
+		std::vector<std::thread> threads;
+		threads.reserve(numThreads);
+
+		auto t0 = std::chrono::steady_clock::now();
+
+		for(std::size_t t = 0; t < numThreads; t++){
+			threads.emplace_back([&, t]{
+				auto fn = makeWorker(t);
+				std::minstd_rand rng(static_cast<std::uint32_t>(t + 1));
+				for(std::size_t i = 0; i < opsPerThread; i++)
+					fn(static_cast<std::uint32_t>(rng() % numShapes));
+			});
+		}
+
+		for(auto &&thread : threads)
+			thread.join();
+
+		auto t1 = std::chrono::steady_clock::now();
+		auto us = std::chrono::duration<double, std::micro>(t1 - t0).count();
+
+		return double(numThreads * opsPerThread) / us;
+	}
+}
+
+int main(int argc, char *argv[]){
+	std::size_t opsPerThread = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+	std::uint32_t numShapes = argc > 2 ? static_cast<std::uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 20000;
+	std::size_t maxThreads = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : std::thread::hardware_concurrency();
+
+	if(maxThreads == 0)
+		maxThreads = 1;
+
+	std::printf("%zu ops/thread over %u shapes\n", opsPerThread, numShapes);
+	std::printf(
+		"%8s %16s %16s %10s %16s %10s %16s %10s %9s\n",
+		"threads", "global mutex", "sharded", "speedup", "sharded (warm)", "speedup", "cached (warm)", "speedup", "hit rate"
+	);
+
+	double base = 0, warmBase = 0, cachedBase = 0;
+
+	for(std::size_t n = 1; n <= maxThreads; n = n < maxThreads && n * 2 > maxThreads ? maxThreads : n * 2){
+		TypeData globalData;
+		std::mutex globalMutex;
+
+		auto global = run(n, opsPerThread, numShapes, [&](std::size_t){
+			return [&](std::uint32_t shape){
+				std::lock_guard<std::mutex> lock(globalMutex);
+				return getShape(globalData, shape);
+			};
+		});
+
+		TypeDataOptions options;
+		options.concurrent = true;
+
+		TypeData shardedData(options);
+
+		auto sharded = run(n, opsPerThread, numShapes, [&](std::size_t){
+			return [&](std::uint32_t shape){ return getShape(shardedData, shape); };
+		});
+
+		for(std::uint32_t shape = 0; shape < numShapes; shape++)
+			getShape(shardedData, shape);
+
+		// every shape exists now, so this only measures the lock-free find path
+		auto warm = run(n, opsPerThread, numShapes, [&](std::size_t){
+			return [&](std::uint32_t shape){ return getShape(shardedData, shape); };
+		});
+
+		// one cache per thread, large enough for every shape and its parts
+		std::vector<TypeCache> caches;
+		caches.reserve(n);
+
+		for(std::size_t t = 0; t < n; t++)
+			caches.emplace_back(shardedData, numShapes * 4);
+
+		auto cached = run(n, opsPerThread, numShapes, [&](std::size_t t){
+			return [&cache = caches[t]](std::uint32_t shape){ return getShape(cache, shape); };
+		});
+
+		double hitRate = 0;
+		for(auto &&cache : caches)
+			hitRate += cache.hitRate() / n;
+
+		if(n == 1){
+			base = sharded;
+			warmBase = warm;
+			cachedBase = cached;
+		}
+
+		std::printf(
+			"%8zu %11.2f Mop/s %11.2f Mop/s %9.2fx %11.2f Mop/s %9.2fx %11.2f Mop/s %9.2fx %8.1f%%\n",
+			n, global, sharded, sharded / base, warm, warm / warmBase, cached, cached / cachedBase, hitRate * 100
+		);
+	}
+}
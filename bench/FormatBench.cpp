@@ -0,0 +1,65 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "ilang/TypeFormatting.hpp"
+
+#include "BenchTypes.hpp"
+
+using namespace ilang;
+using bench::buildTypes;
+
+namespace {
+	template<typename Fn>
+	void run(const char *name, const std::vector<TypeHandle> &types, Fn &&fn){
+		std::size_t numChars = 0;
+
+		auto t0 = std::chrono::steady_clock::now();
+
+		for(auto type : types)
+			numChars += fn(type);
+
+		auto t1 = std::chrono::steady_clock::now();
+		auto ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+		std::printf("%-32s %8.2f ns/op (%zu chars)\n", name, ns / types.size(), numChars);
+	}
+}
+
+int main(int argc, char *argv[]){
+	std::size_t numTypes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+
+	TypeDataOptions options;
+	options.lazyNames = true;
+
+	TypeData data(options);
+	auto types = buildTypes(data, numTypes);
+
+	char buffer[256];
+
+	run("formatTypeName", types, [&](TypeHandle type){ return formatTypeName(data, type, buffer, sizeof(buffer)).size; });
+	run("formatMangledName", types, [&](TypeHandle type){ return formatMangledName(data, type, buffer, sizeof(buffer)).size; });
+
+	FormatOptions limited;
+	limited.maxDepth = 2;
+	limited.maxWidth = 4;
+
+	run("formatTypeName (limited)", types, [&](TypeHandle type){ return formatTypeName(data, type, buffer, sizeof(buffer), limited).size; });
+
+	// names are rendered and cached by the first call
+	run("getTypeName (cold)", types, [&](TypeHandle type){ return getTypeName(data, type).size(); });
+	run("getTypeName (warm)", types, [&](TypeHandle type){ return getTypeName(data, type).size(); });
+
+	std::size_t mismatches = 0;
+	for(auto type : types){
+		auto res = formatTypeName(data, type, buffer, sizeof(buffer));
+		mismatches += !res.truncated && getTypeName(data, type) != std::string_view(buffer, res.size);
+	}
+
+	if(mismatches){
+		std::printf("%zu names differ from getTypeName\n", mismatches);
+		return EXIT_FAILURE;
+	}
+}
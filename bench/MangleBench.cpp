@@ -0,0 +1,73 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "ilang/TypeMangling.hpp"
+
+#include "BenchTypes.hpp"
+
+using namespace ilang;
+using bench::buildTypes;
+
+namespace {
+	template<typename Fn>
+	void run(const char *name, const std::vector<std::string> &names, Fn &&fn){
+		std::size_t hits = 0;
+
+		auto t0 = std::chrono::steady_clock::now();
+
+		for(auto &&mangled : names)
+			hits += fn(mangled) != nullptr;
+
+		auto t1 = std::chrono::steady_clock::now();
+		auto ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+		std::printf("%-28s %8.2f ns/op (%zu hits)\n", name, ns / names.size(), hits);
+	}
+}
+
+int main(int argc, char *argv[]){
+	std::size_t numTypes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+
+	std::vector<std::string> names;
+
+	{
+		TypeData data;
+		for(auto type : buildTypes(data, numTypes))
+			names.emplace_back(getMangledName(data, type));
+	}
+
+	// names are cold: rendered and indexed by the first lookup
+	TypeDataOptions options;
+	options.lazyNames = true;
+
+	{
+		TypeData data(options);
+		buildTypes(data, numTypes);
+		run("findTypeByMangled (cold)", names, [&](const std::string &s){ return findTypeByMangled(data, s); });
+		run("findTypeByMangled (warm)", names, [&](const std::string &s){ return findTypeByMangled(data, s); });
+	}
+
+	{
+		TypeData data(options);
+		auto types = buildTypes(data, numTypes);
+		run("findDemangledType (cold)", names, [&](const std::string &s){ return findDemangledType(data, s); });
+
+		std::size_t mismatches = 0;
+		for(std::size_t i = 0; i < types.size(); i++)
+			mismatches += findDemangledType(data, names[i]) != types[i];
+
+		if(mismatches){
+			std::printf("%zu names did not round trip\n", mismatches);
+			return EXIT_FAILURE;
+		}
+	}
+
+	{
+		TypeData data(options);
+		run("getDemangledType (empty)", names, [&](const std::string &s){ return getDemangledType(data, s); });
+		run("getDemangledType (existing)", names, [&](const std::string &s){ return getDemangledType(data, s); });
+	}
+}
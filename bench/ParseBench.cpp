@@ -0,0 +1,70 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "ilang/TypeParsing.hpp"
+
+#include "BenchTypes.hpp"
+
+using namespace ilang;
+using bench::buildTypes;
+
+namespace {
+	//! Every type built must parse back from its display name
+	bench::TypeMix parseableMix(){
+		bench::TypeMix mix;
+		mix.parseable = true;
+		return mix;
+	}
+
+	template<typename Fn>
+	void run(const char *name, const std::vector<std::string> &names, Fn &&fn){
+		std::size_t hits = 0;
+
+		auto t0 = std::chrono::steady_clock::now();
+
+		for(auto &&str : names)
+			hits += fn(str) != nullptr;
+
+		auto t1 = std::chrono::steady_clock::now();
+		auto s = std::chrono::duration<double>(t1 - t0).count();
+
+		std::printf("%-28s %12.0f types/s %8.2f ns/op (%zu hits)\n", name, names.size() / s, s * 1e9 / names.size(), hits);
+	}
+}
+
+int main(int argc, char *argv[]){
+	std::size_t numTypes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+
+	std::vector<std::string> names;
+
+	{
+		TypeData data;
+		for(auto type : buildTypes(data, numTypes, parseableMix()))
+			names.emplace_back(getTypeName(data, type));
+	}
+
+	{
+		TypeData data;
+		auto types = buildTypes(data, numTypes, parseableMix());
+		run("findTypeByString", names, [&](const std::string &s){ return findTypeByString(data, s); });
+		run("findParsedType", names, [&](const std::string &s){ return findParsedType(data, s); });
+
+		std::size_t mismatches = 0;
+		for(std::size_t i = 0; i < types.size(); i++)
+			mismatches += findParsedType(data, names[i]) != types[i];
+
+		if(mismatches){
+			std::printf("%zu names did not round trip\n", mismatches);
+			return EXIT_FAILURE;
+		}
+	}
+
+	{
+		TypeData data;
+		run("getParsedType (empty)", names, [&](const std::string &s){ return getParsedType(data, s); });
+		run("getParsedType (existing)", names, [&](const std::string &s){ return getParsedType(data, s); });
+	}
+}
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ilang/Type.hpp"
+#include "ilang/TypeRecording.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Print how often each function was called, most frequent first
+	void printCallMix(const TypeWorkload &workload){
+		std::vector<std::size_t> counts(numTypeCalls);
+		for(auto i = workload.numSetupCalls; i < workload.calls.size(); i++)
+			++counts[static_cast<std::size_t>(workload.calls[i].call)];
+
+		std::vector<std::size_t> order(numTypeCalls);
+		for(std::size_t i = 0; i < order.size(); i++)
+			order[i] = i;
+
+		std::stable_sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs){ return counts[lhs] > counts[rhs]; });
+
+		auto numCalls = static_cast<double>(workload.calls.size() - workload.numSetupCalls);
+
+		for(auto i : order){
+			if(counts[i])
+				std::printf("  %-24s %12zu %6.2f%%\n", getTypeCallName(static_cast<TypeCall>(i)), counts[i], 100.0 * counts[i] / numCalls);
+		}
+	}
+}
+
+/**
+ * Usage: ilang-types-replay RECORDING [THREADS] [REPEAT]
+ *
+ * Replays a recording written by startTypeRecording onto fresh type data REPEAT times (default 5),
+ * once on single threaded data and then on concurrent data on 1, 2, 4 ... up to THREADS threads (default 1),
+ * and prints the best time of each.
+ **/
+int main(int argc, char *argv[]){
+	if(argc < 2){
+		std::fprintf(stderr, "usage: %s RECORDING [THREADS] [REPEAT]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::size_t maxThreads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+	std::size_t numRepeats = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 5;
+
+	maxThreads = std::max<std::size_t>(maxThreads, 1);
+	numRepeats = std::max<std::size_t>(numRepeats, 1);
+
+	auto fd = ::open(argv[1], O_RDONLY);
+	if(fd < 0){
+		std::perror(argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	TypeWorkload workload;
+
+	try{
+		workload = readTypeWorkload(fd);
+	}
+	catch(const std::exception &err){
+		std::fprintf(stderr, "%s: %s\n", argv[1], err.what());
+		::close(fd);
+		return EXIT_FAILURE;
+	}
+
+	::close(fd);
+
+	std::printf(
+		"%zu calls after %zu setup calls, %zu type ids, %zu bytes of strings\n",
+		workload.calls.size() - workload.numSetupCalls, workload.numSetupCalls, workload.numTypeIds, workload.strings.size()
+	);
+
+	printCallMix(workload);
+
+	std::printf("%8s %10s %12s %12s %12s %12s %11s\n", "threads", "data", "setup ms", "replay ms", "ns/call", "Mcalls/s", "mismatches");
+
+	//! Replay on \p numThreads threads onto \p concurrent or single threaded data and print the best run
+	auto replay = [&](std::size_t numThreads, bool concurrent){
+		TypeReplayOptions options;
+		options.numThreads = numThreads;
+
+		TypeReplayResult best;
+		best.time = std::chrono::nanoseconds::max();
+
+		for(std::size_t i = 0; i < numRepeats; i++){
+			TypeDataOptions dataOptions;
+			dataOptions.concurrent = concurrent;
+
+			TypeData data(dataOptions);
+
+			try{
+				auto res = replayTypeWorkload(workload, data, options);
+				if(res.time < best.time)
+					best = res;
+			}
+			catch(const std::exception &err){
+				std::fprintf(stderr, "replay failed: %s\n", err.what());
+				return false;
+			}
+		}
+
+		auto ns = static_cast<double>(best.time.count());
+		auto calls = static_cast<double>(std::max<std::uint64_t>(best.numCalls, 1));
+
+		std::printf(
+			"%8zu %10s %12.3f %12.3f %12.2f %12.3f %11llu\n",
+			numThreads, concurrent ? "concurrent" : "single", best.setupTime.count() / 1e6, ns / 1e6, ns / calls, calls / ns * 1e3,
+			static_cast<unsigned long long>(best.numMismatches)
+		);
+
+		return true;
+	};
+
+	// the single threaded row is the baseline, the concurrent ones show the cost of sharing and how it scales
+	if(!replay(1, false))
+		return EXIT_FAILURE;
+
+	for(std::size_t n = 1; n <= maxThreads; n = n < maxThreads && n * 2 > maxThreads ? maxThreads : n * 2){
+		if(!replay(n, true))
+			return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <malloc.h>
+
+#include "ilang/Type.hpp"
+
+#include "BenchTypes.hpp"
+
+using namespace ilang;
+
+namespace {
+	std::size_t numAllocs = 0, numLiveBytes = 0;
+
+	//! Allocations and heap growth of a measured run
+	struct Counters{
+		std::size_t allocs, bytes;
+	};
+
+	Counters counters() noexcept{ return {numAllocs, numLiveBytes}; }
+
+	//! Results of every run are folded in here, so no call is optimized away
+	volatile std::uintptr_t sink = 0;
+
+	template<typename T>
+	std::uintptr_t fold(T *ptr) noexcept{ return reinterpret_cast<std::uintptr_t>(ptr); }
+
+	std::uintptr_t fold(bool b) noexcept{ return b; }
+
+	//! Deterministic pseudo-random indices, so every run queries the same pairs
+	struct Random{
+		std::uint64_t state = 0x9e3779b97f4a7c15;
+
+		std::size_t operator()(std::size_t n) noexcept{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return static_cast<std::size_t>(state % n);
+		}
+	};
+
+	//! Measure \p n calls of \p fn with the call index
+	template<typename Fn>
+	void run(const char *name, std::size_t n, Fn &&fn){
+		std::uintptr_t res = 0;
+
+		auto c0 = counters();
+		auto t0 = std::chrono::steady_clock::now();
+
+		for(std::size_t i = 0; i < n; i++)
+			res += fold(fn(i));
+
+		auto t1 = std::chrono::steady_clock::now();
+		auto c1 = counters();
+
+		sink = sink + res;
+
+		auto ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+		auto allocs = static_cast<double>(c1.allocs - c0.allocs);
+		auto bytes = static_cast<double>(c1.bytes) - static_cast<double>(c0.bytes);
+
+		std::printf("  %-32s %10.2f ns/op %8.3f allocs/op %10.1f bytes/op %10zu ops\n", name, ns / n, allocs / n, bytes / n, n);
+	}
+
+	//! Every kind of compound type; every few types reuse earlier ones as inner types, so the population is a DAG of mixed depth
+	bench::TypeMix populationMix(){
+		bench::TypeMix mix;
+		mix.allKinds = true;
+		return mix;
+	}
+
+	//! Every benchmark over a population of \p n types
+	void runPopulation(const char *name, std::size_t n){
+		std::printf("%s population (%zu types)\n", name, n);
+
+		auto c0 = counters();
+
+		TypeData data;
+		std::vector<TypeHandle> types;
+
+		run("build population", 1, [&](std::size_t){ types = bench::buildTypes(data, n, populationMix()); return types.data(); });
+
+		auto c1 = counters();
+
+		std::printf(
+			"  retained: %zu heap bytes (%zu in type nodes, %zu in names), %.1f bytes/type\n",
+			c1.bytes - c0.bytes, data.arena.bytesAllocated(), data.strings.bytesAllocated(),
+			static_cast<double>(c1.bytes - c0.bytes) / data.storage.size()
+		);
+
+		/*
+		 * Inner types the population never wrapped: static arrays of Unit with sizes it never used.
+		 * Every getter takes the same ones, and each row finds the base the row before created,
+		 * e.g. getListType the trees, so a miss creates exactly one type.
+		 */
+		std::vector<TypeHandle> fresh;
+		for(std::size_t i = 0; i < n + 2; i++)
+			fresh.emplace_back(getStaticArrayType(data, data.unitType, (std::size_t(1) << 40) + i));
+
+		auto at = [&](std::size_t i){ return fresh[i % fresh.size()]; };
+
+		// finds miss before the first pass creates the types, the second pass and the finds after it hit
+	#define BENCH_GETTER(T, ...)\
+		run("find" #T "Type (miss)", n, [&](std::size_t i){ return find##T##Type(data, __VA_ARGS__); });\
+		run("get" #T "Type (miss)", n, [&](std::size_t i){ return get##T##Type(data, __VA_ARGS__); });\
+		run("get" #T "Type (hit)", n, [&](std::size_t i){ return get##T##Type(data, __VA_ARGS__); });\
+		run("find" #T "Type (hit)", n, [&](std::size_t i){ return find##T##Type(data, __VA_ARGS__); });
+
+		BENCH_GETTER(Tree, at(i))
+		BENCH_GETTER(List, at(i))
+		BENCH_GETTER(Array, at(i))
+		BENCH_GETTER(DynamicArray, at(i))
+		BENCH_GETTER(StaticArray, at(i), 3)
+		BENCH_GETTER(Sum, {at(i), at(i + 1)})
+		BENCH_GETTER(Product, {at(i + 1), at(i), at(i + 2)})
+		BENCH_GETTER(Function, {at(i + 2), at(i)}, at(i + 1))
+
+	#undef BENCH_GETTER
+
+		// sized numbers are few, so misses are only measured on the first distinct widths the population never used
+		auto numWidths = std::min<std::size_t>(n, 4096);
+
+	#define BENCH_NUMBER_GETTER(T)\
+		run("find" #T "Type (miss)", numWidths, [&](std::size_t i){ return find##T##Type(data, static_cast<std::uint32_t>(200 + i)); });\
+		run("get" #T "Type (miss)", numWidths, [&](std::size_t i){ return get##T##Type(data, static_cast<std::uint32_t>(200 + i)); });\
+		run("get" #T "Type (hit)", n, [&](std::size_t i){ return get##T##Type(data, static_cast<std::uint32_t>(200 + i % numWidths)); });\
+		run("find" #T "Type (hit)", n, [&](std::size_t i){ return find##T##Type(data, static_cast<std::uint32_t>(200 + i % numWidths)); });
+
+		BENCH_NUMBER_GETTER(Complex)
+		BENCH_NUMBER_GETTER(Imaginary)
+		BENCH_NUMBER_GETTER(Real)
+		BENCH_NUMBER_GETTER(Rational)
+		BENCH_NUMBER_GETTER(Integer)
+		BENCH_NUMBER_GETTER(Natural)
+		BENCH_NUMBER_GETTER(Boolean)
+
+	#undef BENCH_NUMBER_GETTER
+
+		run("getStringType (hit)", n, [&](std::size_t i){ return getStringType(data, i % 2 ? StringEncoding::ascii : StringEncoding::utf8); });
+		run("getPartialType (miss)", std::min<std::size_t>(n, 4096), [&](std::size_t){ return getPartialType(data); });
+
+		std::vector<std::string> names, mangledNames, missingNames;
+		for(auto type : types){
+			names.emplace_back(getTypeName(data, type));
+			mangledNames.emplace_back(getMangledName(data, type));
+			missingNames.emplace_back("(List Missing" + std::to_string(type->id) + ")");
+		}
+
+		run("findTypeByString (hit)", n, [&](std::size_t i){ return findTypeByString(data, names[i % names.size()]); });
+		run("findTypeByString (miss)", n, [&](std::size_t i){ return findTypeByString(data, missingNames[i % names.size()]); });
+		run("findTypeByMangled (hit)", n, [&](std::size_t i){ return findTypeByMangled(data, mangledNames[i % names.size()]); });
+		run("findTypeByMangled (miss)", n, [&](std::size_t i){ return findTypeByMangled(data, missingNames[i % names.size()]); });
+
+		// pairs drawn from the whole population and the prelude, but Infinity which has no base
+		Random random;
+		auto randomType = [&]{ return data.storage[1 + random(data.storage.size() - 1)]; };
+
+		std::vector<std::pair<TypeHandle, TypeHandle>> pairs;
+		for(std::size_t i = 0; i < 4096; i++){
+			auto type0 = randomType();
+			pairs.emplace_back(type0, randomType());
+		}
+
+		auto pair = [&](std::size_t i) -> auto&&{ return pairs[i % pairs.size()]; };
+
+		run("hasBaseType", n, [&](std::size_t i){ return hasBaseType(pair(i).first, pair(i).second); });
+		run("hasBaseType (base)", n, [&](std::size_t i){ return hasBaseType(pair(i).first, pair(i).first->base); });
+		run("findCommonType", n, [&](std::size_t i){ return findCommonType(pair(i).first, pair(i).second); });
+
+	#define BENCH_PREDICATE(T)\
+		run("is" #T "Type", n, [&](std::size_t i){ return is##T##Type(pair(i).first, data); });
+
+		BENCH_PREDICATE(Unit)
+		BENCH_PREDICATE(Type)
+		BENCH_PREDICATE(Partial)
+		BENCH_PREDICATE(Function)
+		BENCH_PREDICATE(Number)
+		BENCH_PREDICATE(String)
+		BENCH_PREDICATE(Tree)
+		BENCH_PREDICATE(List)
+		BENCH_PREDICATE(Array)
+		BENCH_PREDICATE(Complex)
+		BENCH_PREDICATE(Imaginary)
+		BENCH_PREDICATE(Real)
+		BENCH_PREDICATE(Rational)
+		BENCH_PREDICATE(Integer)
+		BENCH_PREDICATE(Natural)
+		BENCH_PREDICATE(Boolean)
+
+	#undef BENCH_PREDICATE
+
+		run("isCompoundType", n, [&](std::size_t i){ return isCompoundType(pair(i).first); });
+		run("isValueType", n, [&](std::size_t i){ return isValueType(pair(i).first); });
+	}
+}
+
+void *operator new(std::size_t size){
+	++numAllocs;
+
+	if(auto p = std::malloc(size ? size : 1)){
+		numLiveBytes += malloc_usable_size(p);
+		return p;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept{
+	if(p) numLiveBytes -= malloc_usable_size(p);
+	std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept{ operator delete(p); }
+
+/**
+ * Usage: ilang-types-bench [SCALE]
+ *
+ * Runs every benchmark over small, medium and huge populations of 1000, 100000 and 1000000 types,
+ * each multiplied by SCALE (default 1).
+ **/
+int main(int argc, char *argv[]){
+	auto scale = argc > 1 ? std::strtod(argv[1], nullptr) : 1.0;
+	auto scaled = [scale](double n){ return std::max<std::size_t>(16, static_cast<std::size_t>(n * scale)); };
+
+	std::printf("TypeData construction\n");
+	run("TypeData()", 1000, [](std::size_t){ TypeData data; return data.booleanType; });
+
+	runPopulation("small", scaled(1e3));
+	runPopulation("medium", scaled(1e5));
+	runPopulation("huge", scaled(1e6));
+}
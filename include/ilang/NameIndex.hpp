@@ -0,0 +1,73 @@
+#ifndef ILANG_NAMEINDEX_HPP
+#define ILANG_NAMEINDEX_HPP 1
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "Published.hpp"
+#include "StringPool.hpp"
+#include "TypeTable.hpp"
+
+/** \file */
+
+namespace ilang{
+	/**
+	 * \brief Hash index from a name to the first type with that name
+	 *
+	 * The names themselves are not stored; slots hold the low bits of the name hash and the type id,
+	 * and candidates are compared against a name column of \ref TypeTable. A bloom filter in front of
+	 * the table answers most lookups of names that were never indexed without touching the slots.
+	 *
+	 * Like \ref TypeInterner, \ref find never waits for a concurrent \ref insert; inserts must be serialized by the caller.
+	 **/
+	struct NameIndex{
+		//! Slots are <tt>hash << 32 | id</tt>
+		using Slot = std::uint64_t;
+
+		//! Slot without a type
+		static constexpr Slot emptySlot = invalidTypeId;
+
+		struct Table{
+			explicit Table(std::size_t n);
+
+			std::size_t capacity;
+			std::unique_ptr<std::atomic<Slot>[]> slots;
+			std::unique_ptr<std::atomic<std::uint64_t>[]> filter;
+		};
+
+		//! Hash a name
+		static std::uint64_t hash(std::string_view name) noexcept;
+
+		//! Find the first type indexed as \p name or \ref invalidTypeId
+		TypeId find(const SegmentedVector<InternedString> &names, std::string_view name) const noexcept{ return find(names, name, hash(name)); }
+
+		//! Find the first type indexed as \p name with \p nameHash or \ref invalidTypeId
+		TypeId find(const SegmentedVector<InternedString> &names, std::string_view name, std::uint64_t nameHash) const noexcept;
+
+		//! Index the type \p id as <tt>names[id]</tt>, unless another type already has that name
+		void insert(const SegmentedVector<InternedString> &names, TypeId id){ insert(names, id, hash(names[id])); }
+
+		//! Index the type \p id as <tt>names[id]</tt> with \p nameHash, unless another type already has that name
+		void insert(const SegmentedVector<InternedString> &names, TypeId id, std::uint64_t nameHash);
+
+		//! Make room for at least \p n names without rehashing
+		void reserve(const SegmentedVector<InternedString> &names, std::size_t n);
+
+		//! Number of indexed names
+		std::size_t size() const noexcept{ return count; }
+
+		//! Bytes allocated for every version of the table; must not overlap an \ref insert
+		std::size_t bytesAllocated() const noexcept;
+
+		Published<Table> table;
+		std::size_t count = 0;
+
+	private:
+		static bool mayContain(const Table &tbl, std::uint64_t nameHash) noexcept;
+		static void addToFilter(Table &tbl, std::uint64_t nameHash) noexcept;
+	};
+}
+
+#endif // !ILANG_NAMEINDEX_HPP
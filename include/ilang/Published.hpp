@@ -0,0 +1,67 @@
+#ifndef ILANG_PUBLISHED_HPP
+#define ILANG_PUBLISHED_HPP 1
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/** \file */
+
+namespace ilang{
+	/**
+	 * \brief Latest version of a \p T, readable without locking while it is being replaced
+	 *
+	 * Readers \ref load the latest version and may keep using it after a newer one is published,
+	 * so replaced versions are only freed with the whole object. Tables that are republished when
+	 * they double in size therefore hold less memory in old versions than in the latest one.
+	 * Only one thread may \ref publish at a time.
+	 **/
+	template<typename T>
+	struct Published{
+		Published() = default;
+
+		Published(Published &&other) noexcept
+			: versions(std::move(other.versions))
+			, current(other.current.exchange(nullptr, std::memory_order_relaxed))
+		{}
+
+		Published(const Published&) = delete;
+
+		Published &operator=(Published &&other) noexcept{
+			if(this != &other){
+				versions = std::move(other.versions);
+				current.store(other.current.exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+
+			return *this;
+		}
+
+		//! Latest version or nullptr if none was published yet
+		T *load() const noexcept{ return current.load(std::memory_order_acquire); }
+
+		//! Make \p next the latest version; it must be completely initialized
+		T *publish(std::unique_ptr<T> next){
+			auto ptr = next.get();
+			versions.emplace_back(std::move(next));
+			current.store(ptr, std::memory_order_release);
+			return ptr;
+		}
+
+		//! Number of versions published so far
+		std::size_t numVersions() const noexcept{ return versions.size(); }
+
+		//! Call \p fn with every version published so far, oldest first; must not overlap a \ref publish
+		template<typename Fn>
+		void forEachVersion(Fn &&fn) const{
+			for(auto &&version : versions)
+				fn(*version);
+		}
+
+	private:
+		std::vector<std::unique_ptr<T>> versions;
+		std::atomic<T*> current{nullptr};
+	};
+}
+
+#endif // !ILANG_PUBLISHED_HPP
@@ -0,0 +1,146 @@
+#ifndef ILANG_SEGMENTEDVECTOR_HPP
+#define ILANG_SEGMENTEDVECTOR_HPP 1
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+/** \file */
+
+namespace ilang{
+	/**
+	 * \brief Growable array whose elements never move
+	 *
+	 * Elements live in segments of doubling size that are allocated on demand and never reallocated,
+	 * so a reference to an element stays valid while other elements are added.
+	 * Different threads may \ref store to different indices at the same time without locking;
+	 * \ref size and iteration are only meaningful while no thread is storing.
+	 **/
+	template<typename T>
+	struct SegmentedVector{
+		//! Number of elements in the first segment, each following segment is twice as large
+		static constexpr std::size_t firstSegmentSize = 256;
+
+		//! Enough segments for every 32-bit index
+		static constexpr std::size_t maxSegments = 25;
+
+		struct iterator{
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const T*;
+			using reference = const T&;
+
+			const SegmentedVector *vec;
+			std::size_t idx;
+
+			const T &operator*() const noexcept{ return (*vec)[idx]; }
+			const T *operator->() const noexcept{ return &(*vec)[idx]; }
+
+			iterator &operator++() noexcept{ ++idx; return *this; }
+			iterator operator++(int) noexcept{ auto it = *this; ++idx; return it; }
+
+			bool operator==(const iterator &other) const noexcept{ return idx == other.idx; }
+			bool operator!=(const iterator &other) const noexcept{ return idx != other.idx; }
+		};
+
+		SegmentedVector() = default;
+
+		SegmentedVector(SegmentedVector &&other) noexcept{ steal(other); }
+
+		SegmentedVector(const SegmentedVector&) = delete;
+
+		~SegmentedVector(){ release(); }
+
+		SegmentedVector &operator=(SegmentedVector &&other) noexcept{
+			if(this != &other){
+				release();
+				steal(other);
+			}
+
+			return *this;
+		}
+
+		//! One past the highest index stored so far
+		std::size_t size() const noexcept{ return len.load(std::memory_order_acquire); }
+		bool empty() const noexcept{ return size() == 0; }
+
+		T &operator[](std::size_t idx) noexcept{
+			auto seg = segmentOf(idx);
+			return segments[seg].load(std::memory_order_acquire)[idx - segmentStart(seg)];
+		}
+
+		const T &operator[](std::size_t idx) const noexcept{
+			auto seg = segmentOf(idx);
+			return segments[seg].load(std::memory_order_acquire)[idx - segmentStart(seg)];
+		}
+
+		T &back() noexcept{ return (*this)[size() - 1]; }
+		const T &back() const noexcept{ return (*this)[size() - 1]; }
+
+		iterator begin() const noexcept{ return {this, 0}; }
+		iterator end() const noexcept{ return {this, size()}; }
+
+		//! Set the element at \p idx, growing the vector if required
+		T &store(std::size_t idx, T value){
+			auto seg = segmentOf(idx);
+			auto ptr = segments[seg].load(std::memory_order_acquire);
+
+			if(!ptr){
+				// racing threads may both allocate the segment, only one of them wins
+				auto fresh = new T[segmentStart(seg + 1) - segmentStart(seg)]();
+				if(segments[seg].compare_exchange_strong(ptr, fresh, std::memory_order_acq_rel))
+					ptr = fresh;
+				else
+					delete[] fresh;
+			}
+
+			auto &&elem = ptr[idx - segmentStart(seg)];
+			elem = std::move(value);
+
+			auto n = len.load(std::memory_order_relaxed);
+			while(n <= idx && !len.compare_exchange_weak(n, idx + 1, std::memory_order_release, std::memory_order_relaxed));
+
+			return elem;
+		}
+
+		T &emplace_back(T value){ return store(size(), std::move(value)); }
+
+	private:
+		static std::size_t segmentOf(std::size_t idx) noexcept{
+			// segment s holds indices [firstSegmentSize * (2^s - 1), firstSegmentSize * (2^(s + 1) - 1))
+			auto n = static_cast<std::uint64_t>(idx / firstSegmentSize + 1);
+		#if defined(__GNUC__) || defined(__clang__)
+			return 63 - __builtin_clzll(n);
+		#else
+			std::size_t seg = 0;
+			while(n >>= 1) ++seg;
+			return seg;
+		#endif
+		}
+
+		static std::size_t segmentStart(std::size_t seg) noexcept{
+			return firstSegmentSize * ((std::size_t(1) << seg) - 1);
+		}
+
+		void steal(SegmentedVector &other) noexcept{
+			for(std::size_t i = 0; i < maxSegments; i++)
+				segments[i].store(other.segments[i].exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+
+			len.store(other.len.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+
+		void release() noexcept{
+			for(auto &&seg : segments)
+				delete[] seg.exchange(nullptr, std::memory_order_relaxed);
+
+			len.store(0, std::memory_order_relaxed);
+		}
+
+		std::atomic<T*> segments[maxSegments] = {};
+		std::atomic<std::size_t> len{0};
+	};
+}
+
+#endif // !ILANG_SEGMENTEDVECTOR_HPP
@@ -0,0 +1,110 @@
+#ifndef ILANG_STRINGPOOL_HPP
+#define ILANG_STRINGPOOL_HPP 1
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "TypeArena.hpp"
+
+/** \file */
+
+namespace ilang{
+	/**
+	 * \brief Handle to a string owned by a \ref StringPool
+	 *
+	 * Every distinct string is stored once per pool, so two strings from the same pool are equal if,
+	 * and only if, their handles are. The string data is null-terminated and prefixed by its length.
+	 **/
+	struct InternedString{
+		InternedString() noexcept: ptr(emptyData()){}
+
+		//! Wrap the data pointer of a string already in a pool
+		explicit InternedString(const char *interned) noexcept: ptr(interned){}
+
+		std::size_t size() const noexcept{
+			std::uint32_t len;
+			std::memcpy(&len, ptr - sizeof(len), sizeof(len));
+			return len;
+		}
+
+		bool empty() const noexcept{ return size() == 0; }
+
+		const char *data() const noexcept{ return ptr; }
+		const char *c_str() const noexcept{ return ptr; }
+
+		std::string_view view() const noexcept{ return {ptr, size()}; }
+		operator std::string_view() const noexcept{ return view(); }
+
+		//! Only meaningful for strings from the same pool
+		friend bool operator==(InternedString lhs, InternedString rhs) noexcept{ return lhs.ptr == rhs.ptr; }
+		friend bool operator!=(InternedString lhs, InternedString rhs) noexcept{ return lhs.ptr != rhs.ptr; }
+
+		friend bool operator==(InternedString lhs, std::string_view rhs) noexcept{ return lhs.view() == rhs; }
+		friend bool operator==(std::string_view lhs, InternedString rhs) noexcept{ return lhs == rhs.view(); }
+		friend bool operator!=(InternedString lhs, std::string_view rhs) noexcept{ return lhs.view() != rhs; }
+		friend bool operator!=(std::string_view lhs, InternedString rhs) noexcept{ return lhs != rhs.view(); }
+
+		friend bool operator==(InternedString lhs, const char *rhs) noexcept{ return lhs.view() == rhs; }
+		friend bool operator!=(InternedString lhs, const char *rhs) noexcept{ return lhs.view() != rhs; }
+
+		friend bool operator<(InternedString lhs, InternedString rhs) noexcept{ return lhs.view() < rhs.view(); }
+		friend bool operator<(InternedString lhs, std::string_view rhs) noexcept{ return lhs.view() < rhs; }
+		friend bool operator<(std::string_view lhs, InternedString rhs) noexcept{ return lhs < rhs.view(); }
+
+		friend std::string operator+(const std::string &lhs, InternedString rhs){ return lhs + std::string(rhs.view()); }
+		friend std::string operator+(InternedString lhs, const std::string &rhs){ return std::string(lhs.view()) + rhs; }
+
+		const char *ptr;
+
+	private:
+		static const char *emptyData() noexcept{
+			alignas(std::uint32_t) static constexpr char empty[sizeof(std::uint32_t) + 1] = {};
+			return empty + sizeof(std::uint32_t);
+		}
+	};
+
+	/**
+	 * \brief Deduplicating string storage
+	 *
+	 * Strings are copied into arena slabs once and never freed until the pool is destroyed.
+	 **/
+	struct StringPool{
+		//! Hash a string
+		static std::uint64_t hash(std::string_view str) noexcept;
+
+		//! Get the handle for \p str, adding it to the pool if required
+		InternedString intern(std::string_view str);
+
+		//! Get the handle for \p str with \p strHash, adding it to the pool if required
+		InternedString intern(std::string_view str, std::uint64_t strHash);
+
+		//! Get the handle for the concatenation of \p parts, adding it to the pool if required
+		InternedString intern(std::initializer_list<std::string_view> parts);
+
+		//! Find the handle for \p str without modifying the pool
+		std::optional<InternedString> find(std::string_view str) const noexcept;
+
+		//! Number of distinct strings in the pool
+		std::size_t size() const noexcept{ return count; }
+
+		//! Number of bytes used for string data
+		std::size_t bytesAllocated() const noexcept{ return arena.bytesAllocated(); }
+
+		struct Slot{
+			std::uint64_t hash;
+			const char *ptr;
+		};
+
+		TypeArena arena;
+		std::vector<Slot> slots;
+		std::size_t count = 0;
+		std::string scratch;
+	};
+}
+
+#endif // !ILANG_STRINGPOOL_HPP
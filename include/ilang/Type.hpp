@@ -1,6 +1,8 @@
 #ifndef ILANG_TYPE_HPP
 #define ILANG_TYPE_HPP 1
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <memory>
@@ -8,6 +10,17 @@
 #include <optional>
 #include <map>
 
+#include "NameIndex.hpp"
+#include "StringPool.hpp"
+#include "TypeArena.hpp"
+#include "TypeInterner.hpp"
+#include "TypeMap.hpp"
+#include "TypeMemory.hpp"
+#include "TypeRecording.hpp"
+#include "TypeShards.hpp"
+#include "TypeStats.hpp"
+#include "TypeTable.hpp"
+
 /** \file */
 
 namespace ilang{
@@ -16,16 +29,93 @@ namespace ilang{
 		ascii, utf8
 	};
 
+	//! Kind of a type
+	enum class TypeKind: std::uint8_t{
+		infinity, root, number, sizedNumber, string, partial,
+		function, sum, product, tree, list, array, dynamicArray, staticArray
+	};
+
+	static_assert(numTypeKinds == static_cast<std::size_t>(TypeKind::staticArray) + 1, "numTypeKinds must count every TypeKind");
+
+	/**
+	 * \brief Classification bits of \ref Type::flags
+	 *
+	 * Family bits (e.g. \c integer) are set on the family's type and inherited by every refinement of it.
+	 **/
+	namespace TypeFlags{
+		enum: std::uint32_t{
+			compound  = 1u << 0,
+			value     = 1u << 1,
+			unit      = 1u << 2,
+			type      = 1u << 3,
+			partial   = 1u << 4,
+			function  = 1u << 5,
+			string    = 1u << 6,
+			tree      = 1u << 7,
+			list      = 1u << 8,
+			array     = 1u << 9,
+			number    = 1u << 10,
+			complex   = 1u << 11,
+			imaginary = 1u << 12,
+			real      = 1u << 13,
+			rational  = 1u << 14,
+			integer   = 1u << 15,
+			natural   = 1u << 16,
+			boolean   = 1u << 17,
+		};
+	}
+
 	//! Data type for type values
 	struct Type{
 		//! Base type of the type.
 		const Type *base = nullptr;
 
-		//! The type name as it would appear in code.
-		std::string str;
+		//! Dense id of the type, also its row in \ref TypeData::table.
+		TypeId id = invalidTypeId;
+
+		/**
+		 * \brief Every type this type is refined from.
+		 *
+		 * Ordered from Infinity down to \ref base, so its size is the depth of the type in
+		 * the refinement tree and <tt>ancestors[d]</tt> is the base of the type at depth \c d.
+		 **/
+		Span<const TypeHandle> ancestors;
+
+		//! Kind of the type.
+		TypeKind kind = TypeKind::root;
+
+		//! Classification bits of the type, see \ref TypeFlags.
+		std::uint32_t flags = 0;
+
+		/**
+		 * \brief Structural parameter of the type.
+		 *
+		 * The length of a static array, the bit-width of a sized number,
+		 * the \ref StringEncoding of an encoded string or the index of a partial type.
+		 **/
+		std::uint64_t param = 0;
+
+		/**
+		 * \brief The type name as it would appear in code.
+		 *
+		 * For compound types this is empty until first requested when names are rendered lazily;
+		 * use \ref getTypeName to read it in that case.
+		 **/
+		mutable InternedString str;
 
-		//! The type name as it would appear in binaries.
-		std::string mangled;
+		/**
+		 * \brief The type name as it would appear in binaries.
+		 *
+		 * Same as \ref str, use \ref getMangledName when names are rendered lazily.
+		 **/
+		mutable InternedString mangled;
+
+		/**
+		 * \brief Whether \ref str and \ref mangled of a compound type were rendered.
+		 *
+		 * Set once the name is stored, so an empty name (e.g. of the empty sum) is rendered only once.
+		 **/
+		mutable std::atomic<bool> strRendered{false}, mangledRendered{false};
 
 		/**
 		 * \brief Inner types of the type.
@@ -43,7 +133,7 @@ namespace ilang{
 		 * list element type.
 		 *
 		 **/
-		std::vector<const Type*> types;
+		Span<const TypeHandle> types;
 		
 		/**
 		 * \brief Names associated with inner types.
@@ -52,11 +142,25 @@ namespace ilang{
 		 * 
 		 * Names are used for compound object types to store their member information
 		 **/
-		std::vector<std::string> names;
+		Span<const InternedString> names;
 	};
 
-	//! \brief Used for type comparisons
-	using TypeHandle = const Type*;
+	//! Options for constructing a \ref TypeData
+	struct TypeDataOptions{
+		//! Render the names of compound types on first access instead of when they are created
+		bool lazyNames = false;
+
+		/**
+		 * \brief Allow every find and get function to be called from several threads at once
+		 *
+		 * Compound types, names and strings are kept in independently locked shards and ids are handed out without locking.
+		 * With \ref lazyNames, the first lookup by name after new compound types were interned renders and indexes them.
+		 **/
+		bool concurrent = false;
+
+		//! Number of interner, name and string shards when \ref concurrent, rounded up to a power of two
+		std::size_t numShards = 64;
+	};
 
 	/**
 	 * \brief Data required for type calculations
@@ -65,7 +169,8 @@ namespace ilang{
 	 * only ever be used with the accompanying find and get functions
 	 **/
 	struct TypeData{
-		TypeData();
+		TypeData(): TypeData(TypeDataOptions{}){}
+		explicit TypeData(const TypeDataOptions &options);
 		
 		TypeData(TypeData&&) = default;
 		TypeData(const TypeData&) = delete;
@@ -79,27 +184,102 @@ namespace ilang{
 		TypeHandle stringType;
 		TypeHandle numberType, complexType, imaginaryType, realType, rationalType, integerType, naturalType, booleanType;
 		TypeHandle functionType;
-		std::map<std::uint32_t, TypeHandle> sizedBooleanTypes;
-		std::map<std::uint32_t, TypeHandle> sizedNaturalTypes;
-		std::map<std::uint32_t, TypeHandle> sizedIntegerTypes;
-		std::map<std::uint32_t, TypeHandle> sizedRationalTypes;
-		std::map<std::uint32_t, TypeHandle> sizedImaginaryTypes;
-		std::map<std::uint32_t, TypeHandle> sizedRealTypes;
-		std::map<std::uint32_t, TypeHandle> sizedComplexTypes;
-		std::map<StringEncoding, TypeHandle> encodedStringTypes;
-		std::map<std::vector<TypeHandle>, std::map<TypeHandle, TypeHandle>> functionTypes;
-		std::map<std::vector<TypeHandle>, TypeHandle> sumTypes;
-		std::map<std::vector<TypeHandle>, TypeHandle> productTypes;
-		std::map<TypeHandle, TypeHandle> treeTypes;
-		std::map<TypeHandle, std::map<TypeHandle, TypeHandle>> mapTypes;
-		std::map<TypeHandle, TypeHandle> listTypes, arrayTypes, dynamicArrayTypes;
-		std::map<TypeHandle, std::map<std::size_t, TypeHandle>> staticArrayTypes;
-		std::vector<TypeHandle> partialTypes;
-		std::vector<std::unique_ptr<Type>> storage;
+		TypeMap<std::uint32_t> sizedBooleanTypes;
+		TypeMap<std::uint32_t> sizedNaturalTypes;
+		TypeMap<std::uint32_t> sizedIntegerTypes;
+		TypeMap<std::uint32_t> sizedRationalTypes;
+		TypeMap<std::uint32_t> sizedImaginaryTypes;
+		TypeMap<std::uint32_t> sizedRealTypes;
+		TypeMap<std::uint32_t> sizedComplexTypes;
+		TypeMap<StringEncoding> encodedStringTypes;
+		TypeInterner internedTypes;
+		SegmentedVector<TypeHandle> partialTypes;
+		//! Every type, indexed by \ref TypeId
+		SegmentedVector<TypeHandle> storage;
+
+		//! Number of types created by the constructor, they have the lowest ids
+		std::size_t numPreludeTypes = 0;
+
+		//! Compact columns describing every type in \ref storage
+		TypeTable table;
+
+		//! Owner of every type and inner type array in \ref storage
+		TypeArena arena;
+
+		//! Owner of every type name, unless shared between threads (see \ref StringShard)
+		mutable StringPool strings;
+
+		//! Whether compound type names are rendered on first access
+		bool lazyNames = false;
+
+		//! Locks and shards when shared between threads, see \ref TypeDataOptions::concurrent
+		std::unique_ptr<TypeShards> shards;
+
+		/**
+		 * \brief Memory used by the types not interned in a shard, see \ref getTypeMemoryReport
+		 *
+		 * Written under \ref TypeShards::mapsMutex when shared between threads, and counts every type otherwise.
+		 **/
+		std::unique_ptr<TypeMemoryCounters> memory;
+
+	#ifdef ILANG_TYPES_STATS
+		//! Statistics counters, see \ref getTypeStats
+		std::unique_ptr<TypeCounters> counters;
+	#endif
+
+	#ifdef ILANG_TYPES_RECORDING
+		//! Writer of every public call while recording, see \ref startTypeRecording
+		std::unique_ptr<TypeRecorder> recorder;
+	#endif
+
+		//! Number of compound type names rendered so far, unless shared between threads (see \ref NameShard)
+		mutable std::size_t numRenderedNames = 0;
+
+		//! Index of display names, see \ref numIndexedNames; split into \ref NameShard "name shards" when shared between threads
+		mutable NameIndex nameIndex;
+
+		//! Index of mangled names, see \ref numIndexedNames; split into \ref NameShard "name shards" when shared between threads
+		mutable NameIndex mangledIndex;
+
+		/**
+		 * \brief Number of types (in id order) added to \ref nameIndex and \ref mangledIndex respectively.
+		 *
+		 * Types are indexed as they are created, unless names are rendered lazily;
+		 * in that case the remaining types are indexed by the first lookup that needs them.
+		 **/
+		mutable std::size_t numIndexedNames = 0, numIndexedMangledNames = 0;
 		
-		std::map<std::string, TypeHandle> typeAliases;
+		std::map<std::string, TypeHandle, std::less<>> typeAliases;
 	};
 
+	//! Make room for \p n more compound types in the interning tables of \p data
+	void reserveTypes(TypeData &data, std::size_t n);
+
+	/**
+	 * \defgroup TypeIds Type ids
+	 * \brief Conversions between \ref TypeHandle and \ref TypeId
+	 * \{
+	 **/
+
+	inline TypeId getTypeId(TypeHandle type) noexcept{ return type->id; }
+	inline TypeHandle getTypeHandle(const TypeData &data, TypeId id) noexcept{ return data.storage[id]; }
+
+	/** \} */
+
+	/**
+	 * \defgroup TypeNames Type names
+	 * \brief Functions for getting the names of a type, rendering them if required
+	 * \{
+	 **/
+
+	//! Get the name of a type as it would appear in code
+	InternedString getTypeName(const TypeData &data, TypeHandle type);
+
+	//! Get the name of a type as it would appear in binaries
+	InternedString getMangledName(const TypeData &data, TypeHandle type);
+
+	/** \} */
+
 	/**
 	 * \defgroup RefinementCheckers Type refinement checking
 	 * \brief Functions for checking refinement of types
@@ -107,6 +287,7 @@ namespace ilang{
 	 **/
 
 	bool hasBaseType(TypeHandle type, TypeHandle baseType) noexcept;
+	bool hasBaseType(const TypeData &data, TypeId type, TypeId baseType) noexcept;
 
 	bool isRootType(TypeHandle type) noexcept;
 	bool isRefinedType(TypeHandle type) noexcept;
@@ -173,6 +354,7 @@ namespace ilang{
 
 	//! Find the most-refined common type
 	TypeHandle findCommonType(TypeHandle type0, TypeHandle type1) noexcept;
+	TypeId findCommonType(const TypeData &data, TypeId type0, TypeId type1) noexcept;
 
 	TypeHandle findInfinityType(const TypeData &data) noexcept;
 	
@@ -201,6 +383,9 @@ namespace ilang{
 	
 	TypeHandle findFunctionType(const TypeData &data) noexcept;
 	TypeHandle findFunctionType(const TypeData &data, const std::vector<TypeHandle> &params, TypeHandle result) noexcept;
+
+	//! Find a compound type by structure, inner types of a sum ordered by id without duplicates
+	TypeHandle findCompoundType(const TypeData &data, const TypeKey &key) noexcept;
 	
 	/** \} */
 
@@ -0,0 +1,168 @@
+#ifndef ILANG_TYPEARENA_HPP
+#define ILANG_TYPEARENA_HPP 1
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/** \file */
+
+namespace ilang{
+	/**
+	 * \brief Non-owning view of a contiguous array
+	 *
+	 * Used for arrays owned by a \ref TypeArena, e.g. the inner types of a type.
+	 **/
+	template<typename T>
+	struct Span{
+		using value_type = std::remove_cv_t<T>;
+		using iterator = T*;
+
+		T *ptr = nullptr;
+		std::size_t len = 0;
+
+		T *data() const noexcept{ return ptr; }
+		std::size_t size() const noexcept{ return len; }
+		bool empty() const noexcept{ return len == 0; }
+
+		T *begin() const noexcept{ return ptr; }
+		T *end() const noexcept{ return ptr + len; }
+
+		T &front() const noexcept{ return ptr[0]; }
+		T &back() const noexcept{ return ptr[len - 1]; }
+
+		T &operator[](std::size_t idx) const noexcept{ return ptr[idx]; }
+	};
+
+	template<typename T>
+	T *begin(const Span<T> &span) noexcept{ return span.begin(); }
+
+	template<typename T>
+	T *end(const Span<T> &span) noexcept{ return span.end(); }
+
+	/**
+	 * \brief Bump allocator for type data
+	 *
+	 * Memory is handed out from large slabs and only ever released all at once when the arena is destroyed,
+	 * so pointers into the arena stay valid for its whole lifetime (including after it has been moved).
+	 **/
+	struct TypeArena{
+		//! Size of a regular slab; larger requests get a slab of their own
+		static constexpr std::size_t slabSize = 256 * 1024;
+
+		TypeArena() = default;
+
+		TypeArena(TypeArena &&other) noexcept
+			: slabs(std::move(other.slabs)), finalizers(std::move(other.finalizers))
+			, cur(std::exchange(other.cur, nullptr)), last(std::exchange(other.last, nullptr))
+			, numBytes(std::exchange(other.numBytes, 0)), numAllocs(std::exchange(other.numAllocs, 0))
+			, numSlabBytes(std::exchange(other.numSlabBytes, 0))
+		{}
+
+		TypeArena(const TypeArena&) = delete;
+
+		~TypeArena(){ release(); }
+
+		TypeArena &operator=(TypeArena &&other) noexcept{
+			if(this != &other){
+				release();
+				slabs = std::move(other.slabs);
+				finalizers = std::move(other.finalizers);
+				cur = std::exchange(other.cur, nullptr);
+				last = std::exchange(other.last, nullptr);
+				numBytes = std::exchange(other.numBytes, 0);
+				numAllocs = std::exchange(other.numAllocs, 0);
+				numSlabBytes = std::exchange(other.numSlabBytes, 0);
+			}
+
+			return *this;
+		}
+
+		//! Get \p size bytes of uninitialized memory aligned to \p align
+		void *allocate(std::size_t size, std::size_t align = alignof(std::max_align_t)){
+			auto p = cur ? alignUp(cur, align) : nullptr;
+			if(!p || p > last || size > std::size_t(last - p)){
+				newSlab(size + align);
+				p = alignUp(cur, align);
+			}
+
+			cur = p + size;
+			numBytes += size;
+			++numAllocs;
+			return p;
+		}
+
+		//! Construct a \p T inside the arena; its destructor is run when the arena is released
+		template<typename T, typename ... Args>
+		T *create(Args &&... args){
+			auto ptr = new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+			if constexpr(!std::is_trivially_destructible_v<T>)
+				finalizers.emplace_back(ptr, [](void *p){ static_cast<T*>(p)->~T(); });
+
+			return ptr;
+		}
+
+		//! Copy the range [\p first, \p stop) into the arena
+		template<typename T, typename It>
+		Span<const T> copy(It first, It stop){
+			static_assert(std::is_trivially_copyable_v<T>, "arena arrays must be trivially copyable");
+
+			auto n = static_cast<std::size_t>(std::distance(first, stop));
+			if(n == 0)
+				return {};
+
+			auto ptr = static_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+			std::uninitialized_copy(first, stop, ptr);
+			return {ptr, n};
+		}
+
+		//! Number of bytes handed out by the arena
+		std::size_t bytesAllocated() const noexcept{ return numBytes; }
+
+		//! Number of bytes in the slabs of the arena, handed out or not
+		std::size_t bytesReserved() const noexcept{ return numSlabBytes; }
+
+		//! Number of allocations served by the arena
+		std::size_t allocationCount() const noexcept{ return numAllocs; }
+
+		//! Number of slabs held by the arena
+		std::size_t slabCount() const noexcept{ return slabs.size(); }
+
+	private:
+		static std::byte *alignUp(std::byte *p, std::size_t align) noexcept{
+			auto addr = reinterpret_cast<std::uintptr_t>(p);
+			return p + ((align - (addr % align)) % align);
+		}
+
+		void newSlab(std::size_t minSize){
+			auto size = minSize > slabSize ? minSize : slabSize;
+			auto &&slab = slabs.emplace_back(new std::byte[size]);
+			cur = slab.get();
+			last = cur + size;
+			numSlabBytes += size;
+		}
+
+		void release() noexcept{
+			for(auto it = finalizers.rbegin(); it != finalizers.rend(); ++it)
+				it->second(it->first);
+
+			finalizers.clear();
+			slabs.clear();
+			cur = last = nullptr;
+			numSlabBytes = 0;
+		}
+
+		std::vector<std::unique_ptr<std::byte[]>> slabs;
+		std::vector<std::pair<void*, void(*)(void*)>> finalizers;
+		std::byte *cur = nullptr, *last = nullptr;
+		std::size_t numBytes = 0, numAllocs = 0, numSlabBytes = 0;
+	};
+}
+
+#endif // !ILANG_TYPEARENA_HPP
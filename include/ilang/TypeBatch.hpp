@@ -0,0 +1,81 @@
+#ifndef ILANG_TYPEBATCH_HPP
+#define ILANG_TYPEBATCH_HPP 1
+
+#include <cstdint>
+#include <vector>
+
+#include "Type.hpp"
+
+/** \file */
+
+namespace ilang{
+	//! Index of a request in a \ref TypeBatch
+	enum class TypeRequest: std::uint32_t{};
+
+	/**
+	 * \brief List of compound types to get at once
+	 *
+	 * Requests may use the results of earlier requests as inner types, so a batch is a DAG in topological order.
+	 * Requests are only recorded here, see \ref getTypes. Every add function throws std::runtime_error
+	 * if an operand is a null type or a request that was not added yet.
+	 **/
+	struct TypeBatch{
+		/**
+		 * \brief Inner type of a request: an existing type or the result of an earlier request
+		 *
+		 * A null type is rejected when the operand is added, so it is never mistaken for the first request.
+		 **/
+		struct Operand{
+			Operand(TypeHandle type_) noexcept: type(type_){}
+			Operand(TypeRequest request_) noexcept: request(request_), isRequest(true){}
+
+			TypeHandle type = nullptr;
+			TypeRequest request{};
+			bool isRequest = false;
+		};
+
+		struct Request{
+			TypeKind kind;
+			std::uint64_t param;
+
+			//! Operands are <tt>operands[firstOperand .. firstOperand + numOperands)</tt>, a function result last
+			std::uint32_t firstOperand, numOperands;
+		};
+
+		TypeRequest addTree(Operand t){ return add(TypeKind::tree, 0, {t}); }
+		TypeRequest addList(Operand t){ return add(TypeKind::list, 0, {t}); }
+		TypeRequest addArray(Operand t){ return add(TypeKind::array, 0, {t}); }
+		TypeRequest addDynamicArray(Operand t){ return add(TypeKind::dynamicArray, 0, {t}); }
+		TypeRequest addStaticArray(Operand t, std::size_t n){ return add(TypeKind::staticArray, n, {t}); }
+
+		TypeRequest addSum(const std::vector<Operand> &innerTypes){ return add(TypeKind::sum, 0, innerTypes); }
+
+		//! \throws std::runtime_error if there are less than 2 inner types, like \ref getProductType
+		TypeRequest addProduct(const std::vector<Operand> &innerTypes);
+
+		TypeRequest addFunction(const std::vector<Operand> &params, Operand result);
+
+		//! Number of requests
+		std::size_t size() const noexcept{ return requests.size(); }
+
+		std::vector<Request> requests;
+		std::vector<Operand> operands;
+
+	private:
+		TypeRequest add(TypeKind kind, std::uint64_t param, const std::vector<Operand> &ops);
+	};
+
+	/**
+	 * \brief Get every type requested by \p batch
+	 *
+	 * Duplicate requests are built once and the interning tables are sized for the whole batch up front.
+	 * If \p data is concurrent (see \ref TypeDataOptions::concurrent), requests that do not depend on each
+	 * other are built by up to \p numThreads threads at once, but no more than there are hardware threads or
+	 * independent requests. Threads that can not be started are done without.
+	 *
+	 * \returns The types in request order, index with <tt>std::size_t(request)</tt>
+	 **/
+	std::vector<TypeHandle> getTypes(TypeData &data, const TypeBatch &batch, std::size_t numThreads = 1);
+}
+
+#endif // !ILANG_TYPEBATCH_HPP
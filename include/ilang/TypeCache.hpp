@@ -0,0 +1,111 @@
+#ifndef ILANG_TYPECACHE_HPP
+#define ILANG_TYPECACHE_HPP 1
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Type.hpp"
+
+/** \file */
+
+namespace ilang{
+	/**
+	 * \brief Per-thread front cache for the find and get functions of a shared \ref TypeData
+	 *
+	 * A direct-mapped table from structural keys to types; a hit only touches memory owned by the cache,
+	 * so threads hammering the same hot types do not share cache lines. Only found types are cached,
+	 * and types are never removed, so entries never go stale.
+	 *
+	 * A cache must only be used by one thread at a time.
+	 **/
+	struct TypeCache{
+		//! Keys with more inner types (including a function result) are not cached, see \ref uncached
+		static constexpr std::size_t maxKeyTypes = 4;
+
+		struct alignas(64) Entry{
+			TypeHandle type = nullptr;
+			std::uint64_t hash = 0;
+			std::uint64_t param = 0;
+			TypeKind kind{};
+			std::uint8_t numTypes = 0;
+			TypeHandle types[maxKeyTypes] = {};
+		};
+
+		//! Create a cache of \p capacity entries (rounded up to a power of two) in front of \p data
+		explicit TypeCache(TypeData &data, std::size_t capacity = 1024);
+
+		//! Fraction of cacheable lookups answered by the cache
+		double hitRate() const noexcept{ return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+
+		//! Drop every entry and reset the counters
+		void clear() noexcept;
+
+		TypeData &data;
+		std::vector<Entry> entries;
+		std::size_t hits = 0, misses = 0;
+
+		//! Lookups of keys with more than \ref maxKeyTypes inner types, which bypass the cache
+		std::size_t uncached = 0;
+	};
+
+	/**
+	 * \defgroup CachedTypeFinders Cached type finding functions
+	 * \brief Same as the \ref TypeFinders "type finding functions", answered from a \ref TypeCache when possible.
+	 * \{
+	 **/
+
+	TypeHandle findStringType(TypeCache &cache, std::optional<StringEncoding> encoding = std::nullopt);
+
+	TypeHandle findTreeType(TypeCache &cache, TypeHandle t);
+	TypeHandle findListType(TypeCache &cache, TypeHandle t);
+	TypeHandle findArrayType(TypeCache &cache, TypeHandle t);
+	TypeHandle findDynamicArrayType(TypeCache &cache, TypeHandle t);
+	TypeHandle findStaticArrayType(TypeCache &cache, TypeHandle t, std::size_t n);
+
+	TypeHandle findComplexType(TypeCache &cache, std::uint32_t numBits = 0);
+	TypeHandle findImaginaryType(TypeCache &cache, std::uint32_t numBits = 0);
+	TypeHandle findRealType(TypeCache &cache, std::uint32_t numBits = 0);
+	TypeHandle findRationalType(TypeCache &cache, std::uint32_t numBits = 0);
+	TypeHandle findIntegerType(TypeCache &cache, std::uint32_t numBits = 0);
+	TypeHandle findNaturalType(TypeCache &cache, std::uint32_t numBits = 0);
+	TypeHandle findBooleanType(TypeCache &cache, std::uint32_t numBits = 0);
+
+	TypeHandle findSumType(TypeCache &cache, std::vector<TypeHandle> innerTypes);
+	TypeHandle findProductType(TypeCache &cache, const std::vector<TypeHandle> &innerTypes);
+
+	TypeHandle findFunctionType(TypeCache &cache, const std::vector<TypeHandle> &params, TypeHandle result);
+
+	/** \} */
+
+	/**
+	 * \defgroup CachedTypeGetters Cached type getting functions
+	 * \brief Same as the \ref TypeGetters "type getting functions", answered from a \ref TypeCache when possible.
+	 * \{
+	 **/
+
+	TypeHandle getStringType(TypeCache &cache, std::optional<StringEncoding> encoding = std::nullopt);
+
+	TypeHandle getTreeType(TypeCache &cache, TypeHandle t);
+	TypeHandle getListType(TypeCache &cache, TypeHandle t);
+	TypeHandle getArrayType(TypeCache &cache, TypeHandle t);
+	TypeHandle getDynamicArrayType(TypeCache &cache, TypeHandle t);
+	TypeHandle getStaticArrayType(TypeCache &cache, TypeHandle t, std::size_t n);
+
+	TypeHandle getComplexType(TypeCache &cache, std::uint32_t numBits = 0);
+	TypeHandle getImaginaryType(TypeCache &cache, std::uint32_t numBits = 0);
+	TypeHandle getRealType(TypeCache &cache, std::uint32_t numBits = 0);
+	TypeHandle getRationalType(TypeCache &cache, std::uint32_t numBits = 0);
+	TypeHandle getIntegerType(TypeCache &cache, std::uint32_t numBits = 0);
+	TypeHandle getNaturalType(TypeCache &cache, std::uint32_t numBits = 0);
+	TypeHandle getBooleanType(TypeCache &cache, std::uint32_t numBits = 0);
+
+	TypeHandle getFunctionType(TypeCache &cache, std::vector<TypeHandle> args, TypeHandle ret);
+
+	TypeHandle getSumType(TypeCache &cache, std::vector<TypeHandle> innerTypes = {});
+	TypeHandle getProductType(TypeCache &cache, std::vector<TypeHandle> innerTypes = {});
+
+	/** \} */
+}
+
+#endif // !ILANG_TYPECACHE_HPP
@@ -0,0 +1,175 @@
+#ifndef ILANG_TYPEFORMATTING_HPP
+#define ILANG_TYPEFORMATTING_HPP 1
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "Type.hpp"
+
+/** \file */
+
+namespace ilang{
+	//! Limits on how much of a type is formatted
+	struct FormatOptions{
+		//! Nesting depth below which inner types are elided as "..."
+		std::size_t maxDepth = SIZE_MAX;
+
+		//! Number of inner types of a sum, product or function formatted before the rest are elided as "..."
+		std::size_t maxWidth = SIZE_MAX;
+	};
+
+	//! Result of formatting into a fixed buffer
+	struct FormatResult{
+		//! Number of characters written, not counting the terminating null
+		std::size_t size = 0;
+
+		//! Whether the buffer was too small for the whole name
+		bool truncated = false;
+	};
+
+	/**
+	 * \brief Writes the names of types piece by piece
+	 *
+	 * Walks the structure of compound types instead of rendering and interning their names,
+	 * so it never allocates and works the same whether names are rendered lazily or not.
+	 * \p Write is called with each piece and returns false to stop formatting.
+	 **/
+	template<typename Write>
+	struct TypeFormatter{
+		Write write;
+		FormatOptions options;
+		std::size_t depth = 0;
+
+		bool number(std::uint64_t n){
+			char buf[20];
+			auto res = std::to_chars(buf, buf + sizeof(buf), n);
+			return write(std::string_view(buf, static_cast<std::size_t>(res.ptr - buf)));
+		}
+
+		//! Display names of \p types separated by \p sep
+		bool joinedName(Span<const TypeHandle> types, std::string_view sep){
+			for(std::size_t i = 0; i < types.size(); i++){
+				if(i > 0 && !write(sep))
+					return false;
+
+				if(i == options.maxWidth)
+					return write("...");
+
+				if(!name(types[i]))
+					return false;
+			}
+
+			return true;
+		}
+
+		//! Display name of \p type, see \ref getTypeName
+		bool name(TypeHandle type){
+			if(!isCompoundType(type))
+				return write(type->str);
+			else if(depth == options.maxDepth)
+				return write("...");
+
+			++depth;
+
+			bool res;
+			switch(type->kind){
+				case TypeKind::tree: res = write("(Tree ") && name(type->types[0]) && write(")"); break;
+				case TypeKind::list: res = write("(List ") && name(type->types[0]) && write(")"); break;
+				case TypeKind::array: res = write("(Array ") && name(type->types[0]) && write(")"); break;
+				case TypeKind::dynamicArray: res = write("(DynamicArray ") && name(type->types[0]) && write(")"); break;
+				case TypeKind::staticArray: res = write("(StaticArray ") && name(type->types[0]) && write(" ") && number(type->param) && write(")"); break;
+				case TypeKind::sum: res = joinedName(type->types, " | "); break;
+				case TypeKind::product: res = joinedName(type->types, " * "); break;
+				default: res = joinedName(type->types, " -> "); break;
+			}
+
+			--depth;
+			return res;
+		}
+
+		//! Mangled names of \p n types starting at \p types
+		bool mangledList(const TypeHandle *types, std::size_t n){
+			for(std::size_t i = 0; i < n; i++){
+				if(i == options.maxWidth)
+					return write("...");
+
+				if(!mangledName(types[i]))
+					return false;
+			}
+
+			return true;
+		}
+
+		//! Mangled name of \p type, see \ref getMangledName
+		bool mangledName(TypeHandle type){
+			if(!isCompoundType(type))
+				return write(type->mangled);
+			else if(depth == options.maxDepth)
+				return write("...");
+
+			++depth;
+
+			bool res;
+			auto &&types = type->types;
+
+			switch(type->kind){
+				case TypeKind::tree: res = write("ot0") && mangledName(types[0]); break;
+				case TypeKind::list: res = write("ol0") && mangledName(types[0]); break;
+				case TypeKind::array: res = write("oa0") && mangledName(types[0]); break;
+				case TypeKind::dynamicArray: res = write("ad") && mangledName(types[0]); break;
+				case TypeKind::staticArray: res = write("a") && number(type->param) && mangledName(types[0]); break;
+				case TypeKind::sum: res = write("u") && number(types.size()) && mangledList(types.data(), types.size()); break;
+				case TypeKind::product: res = write("p") && number(types.size()) && mangledList(types.data(), types.size()); break;
+
+				default:{
+					// arity, then the result, then the parameters
+					auto numParams = types.size() - 1;
+					res = write("f") && number(numParams) && mangledName(types[numParams]) && mangledList(types.data(), numParams);
+					break;
+				}
+			}
+
+			--depth;
+			return res;
+		}
+	};
+
+	/**
+	 * \defgroup TypeFormatting Type formatting
+	 * \brief Functions for writing type names without building strings
+	 *
+	 * The output is the same as \ref getTypeName or \ref getMangledName unless \ref FormatOptions elide
+	 * some of it. Inner types shared between branches are formatted once per use, so the limits also
+	 * bound the cost of formatting a single pathological type. Elided mangled names do not demangle.
+	 * \{
+	 **/
+
+	//! Write the display name of \p type to \p out
+	template<typename OutputIt>
+	OutputIt formatTypeName(const TypeData&, TypeHandle type, OutputIt out, const FormatOptions &options = {}){
+		auto write = [&out](std::string_view str){ out = std::copy(str.begin(), str.end(), out); return true; };
+		TypeFormatter<decltype(write)>{write, options}.name(type);
+		return out;
+	}
+
+	//! Write the mangled name of \p type to \p out
+	template<typename OutputIt>
+	OutputIt formatMangledName(const TypeData&, TypeHandle type, OutputIt out, const FormatOptions &options = {}){
+		auto write = [&out](std::string_view str){ out = std::copy(str.begin(), str.end(), out); return true; };
+		TypeFormatter<decltype(write)>{write, options}.mangledName(type);
+		return out;
+	}
+
+	//! Write the display name of \p type, null terminated, to the \p size bytes at \p buffer
+	FormatResult formatTypeName(const TypeData &data, TypeHandle type, char *buffer, std::size_t size, const FormatOptions &options = {}) noexcept;
+
+	//! Write the mangled name of \p type, null terminated, to the \p size bytes at \p buffer
+	FormatResult formatMangledName(const TypeData &data, TypeHandle type, char *buffer, std::size_t size, const FormatOptions &options = {}) noexcept;
+
+	/** \} */
+}
+
+#endif // !ILANG_TYPEFORMATTING_HPP
@@ -0,0 +1,108 @@
+#ifndef ILANG_TYPEIO_HPP
+#define ILANG_TYPEIO_HPP 1
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Type.hpp"
+
+/** \file */
+
+namespace ilang{
+	//! Version of the binary format written by \ref writeTypeData, bumped on every incompatible change
+	constexpr std::uint32_t typeDataFormatVersion = 1;
+
+	/**
+	 * \brief Buffered writer to a file descriptor
+	 *
+	 * Nothing is written until the buffer is full or \ref flush is called; the destructor does not flush.
+	 * \throws std::system_error if writing fails
+	 **/
+	struct FileWriter{
+		explicit FileWriter(int fd, std::size_t bufferSize = 64 * 1024);
+
+		void write(const void *bytes, std::size_t n);
+		void writeByte(std::uint8_t byte);
+
+		//! Write \p value in LEB128, 7 bits per byte
+		void writeVarint(std::uint64_t value);
+
+		void flush();
+
+		int fd;
+		std::vector<char> buffer;
+		std::size_t len = 0;
+	};
+
+	/**
+	 * \brief Buffered reader from a file descriptor
+	 *
+	 * \throws std::system_error if reading fails
+	 * \throws std::runtime_error if the file ends before a read is satisfied
+	 **/
+	struct FileReader{
+		explicit FileReader(int fd, std::size_t bufferSize = 64 * 1024);
+
+		void read(void *bytes, std::size_t n);
+		std::uint8_t readByte();
+		std::uint64_t readVarint();
+
+		//! Whether every byte of the file has been read
+		bool atEnd();
+
+		//! Number of bytes read so far
+		std::uint64_t offset() const noexcept{ return numFilled - (len - pos); }
+
+		int fd;
+		std::vector<char> buffer;
+		std::size_t pos = 0, len = 0;
+		std::uint64_t numFilled = 0;
+
+	private:
+		//! Refill the buffer, returns false at the end of the file
+		bool fill();
+	};
+
+	//! Hash of the structure and names of the prelude of \p data, so types are only read into a matching prelude
+	std::uint64_t hashPrelude(const TypeData &data);
+
+	/**
+	 * \brief Write the record of a type created after the prelude
+	 *
+	 * A record is the kind of the type followed by its structure, inner types as ids.
+	 **/
+	void writeTypeRecord(FileWriter &writer, TypeHandle type);
+
+	/**
+	 * \brief Read a type record and get the type it describes
+	 *
+	 * Records must be read in the order their types were created, so each one creates the next id of \p data.
+	 * \throws std::runtime_error if the record is malformed or does not create the next type
+	 **/
+	TypeHandle readTypeRecord(FileReader &reader, TypeData &data);
+
+	/**
+	 * \brief Read a type record and check that it describes \p type, without creating any type
+	 * \throws std::runtime_error if the record is malformed
+	 **/
+	bool matchTypeRecord(FileReader &reader, const TypeData &data, TypeHandle type);
+
+	/**
+	 * \brief Write every type and alias of \p data to \p fd
+	 *
+	 * Only structure is written, names are rendered again when the data is read.
+	 * \p data must not be modified while it is written.
+	 **/
+	void writeTypeData(const TypeData &data, int fd);
+
+	/**
+	 * \brief Read types written by \ref writeTypeData from \p fd
+	 *
+	 * Every type gets the same id and name it had when written.
+	 * \throws std::runtime_error if the data is malformed, of another \ref typeDataFormatVersion or has another prelude
+	 **/
+	TypeData readTypeData(int fd, const TypeDataOptions &options = {});
+}
+
+#endif // !ILANG_TYPEIO_HPP
@@ -0,0 +1,169 @@
+#ifndef ILANG_TYPEIMAGE_HPP
+#define ILANG_TYPEIMAGE_HPP 1
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "Type.hpp"
+
+/** \file */
+
+namespace ilang{
+	//! Version of the image layout written by \ref writeTypeImage, bumped on every incompatible change
+	constexpr std::uint32_t typeImageFormatVersion = 2;
+
+	/**
+	 * \brief Read-only types used in place from a prebuilt image
+	 *
+	 * An image holds every type of a \ref TypeData as fixed-size records that refer to each other, to inner types
+	 * and to their names by offset, along with prebuilt hash indices for names, mangled names and structure.
+	 * Nothing is deserialized: mapping an image only reads its header and every query reads the image directly,
+	 * so processes mapping the same file share its pages through the page cache.
+	 *
+	 * Images are trusted: only the header and section bounds are checked when an image is opened.
+	 **/
+	struct TypeImage{
+		//! Image layout, every offset is in bytes from the start of the image
+		struct Header{
+			char magic[4];
+			std::uint32_t version;
+			std::uint32_t numTypes, numAliases;
+
+			//! Ids of the number families, from Complex to Boolean
+			TypeId numberFamilies[7];
+
+			std::uint32_t nameIndexCapacity, mangledIndexCapacity, structIndexCapacity;
+
+			std::uint64_t recordsOffset, ancestorsOffset, childrenOffset;
+			std::uint64_t stringsOffset, stringsSize;
+			std::uint64_t aliasesOffset;
+			std::uint64_t nameIndexOffset, mangledIndexOffset, structIndexOffset;
+		};
+
+		//! A type, its ancestors and children are ranges of the id arrays
+		struct Record{
+			TypeId base;
+			std::uint32_t depth, firstAncestor;
+			std::uint32_t firstChild, numChildren;
+			std::uint32_t flags;
+			std::uint64_t param;
+
+			//! Offsets of the names in the string blob
+			std::uint32_t name, mangled;
+
+			TypeKind kind;
+
+			//! Index in \ref Header::numberFamilies of a sized number, sized numbers of the prelude are refined from each other
+			std::uint8_t family;
+
+			std::uint8_t padding[6];
+		};
+
+		//! Alias, sorted by name
+		struct Alias{
+			std::uint32_t name;
+			TypeId type;
+		};
+
+		//! Index slots are <tt>hash << 32 | id</tt>, like those of \ref NameIndex
+		using Slot = std::uint64_t;
+
+		/**
+		 * \brief Map the image file at \p path
+		 * \throws std::system_error if the file can not be mapped
+		 * \throws std::runtime_error if it is not an image of this \ref typeImageFormatVersion
+		 **/
+		static TypeImage map(const char *path);
+
+		//! Use an image already in memory, which must outlive the image and be aligned to 8 bytes
+		TypeImage(const void *bytes, std::size_t size);
+
+		TypeImage(TypeImage &&other) noexcept;
+		TypeImage(const TypeImage&) = delete;
+
+		TypeImage &operator=(TypeImage &&other) noexcept;
+
+		~TypeImage();
+
+		std::size_t numTypes() const noexcept{ return header->numTypes; }
+
+		const Record &record(TypeId id) const noexcept{ return records[id]; }
+
+		Span<const TypeId> childrenOf(TypeId id) const noexcept{
+			return {ids(header->childrenOffset) + records[id].firstChild, records[id].numChildren};
+		}
+
+		//! Every base of \p id, from Infinity down to its direct base
+		Span<const TypeId> ancestorsOf(TypeId id) const noexcept{
+			return {ids(header->ancestorsOffset) + records[id].firstAncestor, records[id].depth};
+		}
+
+		//! Get the string at \p offset of the string blob
+		InternedString string(std::uint32_t offset) const noexcept{
+			return InternedString(bytes + header->stringsOffset + offset);
+		}
+
+		const char *bytes = nullptr;
+		std::size_t size = 0;
+		const Header *header = nullptr;
+		const Record *records = nullptr;
+
+		//! Whether the image was mapped by \ref map, and must be unmapped
+		bool mapped = false;
+
+	private:
+		const TypeId *ids(std::uint64_t offset) const noexcept{
+			return reinterpret_cast<const TypeId*>(bytes + offset);
+		}
+
+		void release() noexcept;
+	};
+
+	/**
+	 * \brief Write an image of every type in \p data to \p fd
+	 *
+	 * Names are rendered if required; \p data must not be modified while it is written.
+	 **/
+	void writeTypeImage(const TypeData &data, int fd);
+
+	/**
+	 * \defgroup ImageTypeQueries Image type queries
+	 * \brief Same as the functions on a \ref TypeData, for types of a \ref TypeImage.
+	 * \returns \ref invalidTypeId if a type could not be found
+	 * \{
+	 **/
+
+	InternedString getTypeName(const TypeImage &image, TypeId type) noexcept;
+	InternedString getMangledName(const TypeImage &image, TypeId type) noexcept;
+
+	bool hasBaseType(const TypeImage &image, TypeId type, TypeId baseType) noexcept;
+
+	TypeId findTypeByString(const TypeImage &image, std::string_view str) noexcept;
+	TypeId findTypeByMangled(const TypeImage &image, std::string_view mangled) noexcept;
+
+	TypeId findCommonType(const TypeImage &image, TypeId type0, TypeId type1) noexcept;
+
+	TypeId findTreeType(const TypeImage &image, TypeId t) noexcept;
+	TypeId findListType(const TypeImage &image, TypeId t) noexcept;
+	TypeId findArrayType(const TypeImage &image, TypeId t) noexcept;
+	TypeId findDynamicArrayType(const TypeImage &image, TypeId t) noexcept;
+	TypeId findStaticArrayType(const TypeImage &image, TypeId t, std::size_t n) noexcept;
+
+	TypeId findComplexType(const TypeImage &image, std::uint32_t numBits = 0) noexcept;
+	TypeId findImaginaryType(const TypeImage &image, std::uint32_t numBits = 0) noexcept;
+	TypeId findRealType(const TypeImage &image, std::uint32_t numBits = 0) noexcept;
+	TypeId findRationalType(const TypeImage &image, std::uint32_t numBits = 0) noexcept;
+	TypeId findIntegerType(const TypeImage &image, std::uint32_t numBits = 0) noexcept;
+	TypeId findNaturalType(const TypeImage &image, std::uint32_t numBits = 0) noexcept;
+	TypeId findBooleanType(const TypeImage &image, std::uint32_t numBits = 0) noexcept;
+
+	TypeId findSumType(const TypeImage &image, std::vector<TypeId> innerTypes) noexcept;
+	TypeId findProductType(const TypeImage &image, const std::vector<TypeId> &innerTypes) noexcept;
+	TypeId findFunctionType(const TypeImage &image, const std::vector<TypeId> &params, TypeId result) noexcept;
+
+	/** \} */
+}
+
+#endif // !ILANG_TYPEIMAGE_HPP
@@ -0,0 +1,90 @@
+#ifndef ILANG_TYPEINTERNER_HPP
+#define ILANG_TYPEINTERNER_HPP 1
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include "Published.hpp"
+#include "TypeTable.hpp"
+
+/** \file */
+
+namespace ilang{
+	struct TypeData;
+
+	/**
+	 * \brief Structural key of a compound type
+	 *
+	 * Two compound types are the same type if, and only if, their keys are equal.
+	 **/
+	struct TypeKey{
+		//! Kind of the type
+		TypeKind kind;
+
+		//! Inner types of the type
+		const TypeHandle *types = nullptr;
+
+		//! Number of inner types
+		std::size_t numTypes = 0;
+
+		//! Result type of a function type, appended to the inner types when non-null
+		TypeHandle result = nullptr;
+
+		//! Structural parameter (e.g. the length of a static array)
+		std::uint64_t param = 0;
+	};
+
+	/**
+	 * \brief Hash-consing table for compound types
+	 *
+	 * Open-addressing (linear probing) table mapping a \ref TypeKey to the unique type with that structure.
+	 * Slots only hold the low bits of the structural hash and the type id; keys are compared against
+	 * the columns of \ref TypeData::table.
+	 *
+	 * Slots are atomic and the table is \ref Published, so \ref find never waits for a concurrent
+	 * \ref insert; inserts must be serialized by the caller.
+	 **/
+	struct TypeInterner{
+		//! Slots are <tt>hash << 32 | id</tt>
+		using Slot = std::uint64_t;
+
+		//! Slot without a type
+		static constexpr Slot emptySlot = invalidTypeId;
+
+		struct Table{
+			explicit Table(std::size_t n);
+
+			std::size_t capacity;
+			std::unique_ptr<std::atomic<Slot>[]> slots;
+		};
+
+		//! Hash a type key
+		static std::uint64_t hash(const TypeKey &key) noexcept;
+
+		//! Find the type with structure \p key or nullptr if it has not been interned
+		TypeHandle find(const TypeData &data, const TypeKey &key) const noexcept{ return find(data, key, hash(key)); }
+		TypeHandle find(const TypeData &data, const TypeKey &key, std::uint64_t keyHash) const noexcept;
+
+		/**
+		 * \brief Intern a new type
+		 *
+		 * The type must not already be interned and \p keyHash must be the hash of its key.
+		 **/
+		void insert(TypeHandle type, std::uint64_t keyHash);
+
+		//! Make room for at least \p n types without rehashing
+		void reserve(std::size_t n);
+
+		std::size_t size() const noexcept{ return count; }
+
+		//! Bytes allocated for every version of the table; must not overlap an \ref insert
+		std::size_t bytesAllocated() const noexcept;
+
+		Published<Table> table;
+		std::size_t count = 0;
+	};
+}
+
+#endif // !ILANG_TYPEINTERNER_HPP
@@ -0,0 +1,93 @@
+#ifndef ILANG_TYPEJOURNAL_HPP
+#define ILANG_TYPEJOURNAL_HPP 1
+
+#include <cstddef>
+#include <cstdint>
+
+#include "TypeIO.hpp"
+
+/** \file */
+
+namespace ilang{
+	/**
+	 * \brief Append-only log of the types created in a \ref TypeData
+	 *
+	 * Types are only ever added, so a snapshot (see \ref writeTypeData) followed by the records of every
+	 * type created since is enough to rebuild the data. A journal starts at the number of types
+	 * its data had when the journal was started or last compacted, and must be replayed onto exactly those.
+	 *
+	 * \p data must not be modified while the journal is written or compacted.
+	 **/
+	struct TypeJournal{
+		/**
+		 * \brief Continue the journal in \p fd for \p data
+		 *
+		 * An empty file starts a new journal at the current types of \p data.
+		 * Otherwise the journal is replayed into \p data first; a record torn by a crash while it was
+		 * appended is cut off the end of the file. A journal starting before the types of \p data is
+		 * taken to be left over from an interrupted \ref compactJournal: it is restarted once every one of
+		 * its records was checked against the types \p data already has.
+		 *
+		 * \throws std::runtime_error if the journal does not continue the types of \p data, has types
+		 * \p data is missing or is malformed
+		 **/
+		TypeJournal(TypeData &data, int fd);
+
+		TypeData &data;
+		int fd;
+
+		//! Number of types the journal starts at
+		std::size_t numBaseTypes = 0;
+
+		//! Number of types in the snapshot and journal together
+		std::size_t numPersisted = 0;
+
+		//! Number of types read from the journal when it was opened
+		std::size_t numReplayed = 0;
+	};
+
+	/**
+	 * \brief Append the records of every type created since the last write
+	 *
+	 * If appending fails, the journal is truncated back to where the append started and the file offset
+	 * is restored before the error is rethrown, so the journal stays replayable and a later call retries
+	 * the same types.
+	 *
+	 * \param durable Whether to wait until the records are on disk
+	 * \returns The number of records appended
+	 * \throws std::system_error if writing or syncing fails
+	 **/
+	std::size_t writeJournal(TypeJournal &journal, bool durable = false);
+
+	/**
+	 * \brief Write a snapshot of every type to \p snapshotFd and wait until it is on disk
+	 *
+	 * First step of a compaction, the journal is left as is.
+	 * \throws std::system_error if writing or syncing fails
+	 **/
+	void writeJournalSnapshot(const TypeJournal &journal, int snapshotFd);
+
+	/**
+	 * \brief Empty the journal and start it again at the current types
+	 *
+	 * Last step of a compaction, only once the snapshot of those types is in place for good:
+	 * the records it replaces are gone.
+	 * \throws std::system_error if truncating or writing fails
+	 **/
+	void restartJournal(TypeJournal &journal);
+
+	/**
+	 * \brief Write a snapshot of every type to \p snapshotFd and restart the journal at it
+	 *
+	 * \p commit is called in between to put the durable snapshot in place, e.g. by renaming it over the
+	 * previous one and syncing the directory; if it throws, the journal is left as is.
+	 **/
+	template<typename Commit>
+	void compactJournal(TypeJournal &journal, int snapshotFd, Commit &&commit){
+		writeJournalSnapshot(journal, snapshotFd);
+		commit();
+		restartJournal(journal);
+	}
+}
+
+#endif // !ILANG_TYPEJOURNAL_HPP
@@ -0,0 +1,49 @@
+#ifndef ILANG_TYPEMANGLING_HPP
+#define ILANG_TYPEMANGLING_HPP 1
+
+#include <string_view>
+
+#include "Type.hpp"
+
+/** \file */
+
+namespace ilang{
+	/**
+	 * \defgroup TypeDemangling Type demangling
+	 * \brief Functions for getting a type back from its mangled name
+	 *
+	 * Mangled names (see \ref getMangledName) follow a prefix-free grammar, so every name is decoded
+	 * in a single pass without lookahead and every type has exactly one name:
+	 *
+	 * \code
+	 * type    := '??'                              Infinity
+	 *          | '_?' | '_' N                      Partial, the partial type with index N
+	 *          | 't?' | 'p0' | 'w?' | 'f?'         Type, Unit, Number, Function
+	 *          | 's?' | 'sa8' | 'su8'              String, AsciiString, Utf8String
+	 *          | F '?' | F N                       a number family or a sized number of it, N bits
+	 *          | 'ot0' type | 'ol0' type | 'oa0' type
+	 *          | 'ad' type                         DynamicArray
+	 *          | 'a' N type                        StaticArray of N elements
+	 *          | 'u' N type{N}                     sum of N inner types, ordered by id
+	 *          | 'p' N type{N}                     product of N >= 2 inner types
+	 *          | 'f' N type type{N}                function of N parameters, result first
+	 * F       := 'c' | 'i' | 'r' | 'q' | 'z' | 'n' | 'b'
+	 * N       := '0' | [1-9][0-9]*
+	 * \endcode
+	 *
+	 * Inner types are decoded on the stack, only lists of more than 16 of them allocate;
+	 * if that allocation fails, \ref findDemangledType returns nullptr.
+	 * \returns The type or nullptr if the name is malformed or, when finding, the type does not exist.
+	 * \{
+	 **/
+
+	//! Find the type named \p mangled
+	TypeHandle findDemangledType(const TypeData &data, std::string_view mangled) noexcept;
+
+	//! Get the type named \p mangled, creating it and its inner types if required
+	TypeHandle getDemangledType(TypeData &data, std::string_view mangled);
+
+	/** \} */
+}
+
+#endif // !ILANG_TYPEMANGLING_HPP
@@ -0,0 +1,133 @@
+#ifndef ILANG_TYPEMAP_HPP
+#define ILANG_TYPEMAP_HPP 1
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "Published.hpp"
+#include "TypeTable.hpp"
+
+/** \file */
+
+namespace ilang{
+	/**
+	 * \brief Map from an integral (or enum) key to a type
+	 *
+	 * Used for the small families of types that are not interned by structure, e.g. sized numbers by bit-width.
+	 * Like \ref TypeInterner, \ref find never waits for a concurrent \ref emplace; emplaces must be serialized by the caller.
+	 **/
+	template<typename Key>
+	struct TypeMap{
+		struct Table{
+			explicit Table(std::size_t n)
+				: capacity(n), keys(new std::atomic<std::uint64_t>[n]), types(new std::atomic<TypeHandle>[n])
+			{
+				for(std::size_t i = 0; i < n; i++){
+					keys[i].store(0, std::memory_order_relaxed);
+					types[i].store(nullptr, std::memory_order_relaxed);
+				}
+			}
+
+			std::size_t capacity;
+
+			//! Stored keys are offset by one, so 0 is an empty slot
+			std::unique_ptr<std::atomic<std::uint64_t>[]> keys;
+			std::unique_ptr<std::atomic<TypeHandle>[]> types;
+		};
+
+		//! Find the type for \p key or nullptr
+		TypeHandle find(Key key) const noexcept{
+			auto tbl = table.load();
+			if(!tbl)
+				return nullptr;
+
+			auto k = encode(key);
+			auto mask = tbl->capacity - 1;
+
+			for(auto i = slotOf(k) & mask; ; i = (i + 1) & mask){
+				auto stored = tbl->keys[i].load(std::memory_order_acquire);
+				if(stored == 0)
+					return nullptr;
+				else if(stored == k)
+					return tbl->types[i].load(std::memory_order_relaxed);
+			}
+		}
+
+		//! Map \p key to \p type; \p key must not be mapped yet
+		void emplace(Key key, TypeHandle type){
+			grow();
+
+			auto tbl = table.load();
+			auto k = encode(key);
+			auto mask = tbl->capacity - 1;
+			auto i = slotOf(k) & mask;
+
+			while(tbl->keys[i].load(std::memory_order_relaxed) != 0)
+				i = (i + 1) & mask;
+
+			// the type is stored before the key publishes it
+			tbl->types[i].store(type, std::memory_order_relaxed);
+			tbl->keys[i].store(k, std::memory_order_release);
+			++count;
+		}
+
+		std::size_t size() const noexcept{ return count; }
+
+		//! Call \p fn with every key and its type; must not overlap an \ref emplace
+		template<typename Fn>
+		void forEach(Fn &&fn) const{
+			auto tbl = table.load();
+			for(std::size_t i = 0; tbl && i < tbl->capacity; i++){
+				auto k = tbl->keys[i].load(std::memory_order_relaxed);
+				if(k != 0)
+					fn(static_cast<Key>(k - 1), tbl->types[i].load(std::memory_order_relaxed));
+			}
+		}
+
+		//! Bytes allocated for every version of the table; must not overlap an \ref emplace
+		std::size_t bytesAllocated() const noexcept{
+			std::size_t n = 0;
+			table.forEachVersion([&n](const Table &tbl){ n += sizeof(Table) + (sizeof(std::uint64_t) + sizeof(TypeHandle)) * tbl.capacity; });
+			return n;
+		}
+
+		Published<Table> table;
+		std::size_t count = 0;
+
+	private:
+		static std::uint64_t encode(Key key) noexcept{ return static_cast<std::uint64_t>(key) + 1; }
+
+		static std::size_t slotOf(std::uint64_t k) noexcept{
+			return static_cast<std::size_t>((k * 0x9e3779b97f4a7c15ull) >> 32);
+		}
+
+		void grow(){
+			auto old = table.load();
+
+			// keep the load factor at or below 1/2, maps are small
+			if(old && (count + 1) * 2 <= old->capacity)
+				return;
+
+			auto capacity = old ? old->capacity * 2 : 16;
+			auto tbl = std::make_unique<Table>(capacity);
+			auto mask = capacity - 1;
+
+			for(std::size_t j = 0; old && j < old->capacity; j++){
+				auto k = old->keys[j].load(std::memory_order_relaxed);
+				if(k == 0) continue;
+
+				auto i = slotOf(k) & mask;
+				while(tbl->keys[i].load(std::memory_order_relaxed) != 0)
+					i = (i + 1) & mask;
+
+				tbl->types[i].store(old->types[j].load(std::memory_order_relaxed), std::memory_order_relaxed);
+				tbl->keys[i].store(k, std::memory_order_relaxed);
+			}
+
+			table.publish(std::move(tbl));
+		}
+	};
+}
+
+#endif // !ILANG_TYPEMAP_HPP
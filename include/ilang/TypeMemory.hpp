@@ -0,0 +1,93 @@
+#ifndef ILANG_TYPEMEMORY_HPP
+#define ILANG_TYPEMEMORY_HPP 1
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "TypeStats.hpp"
+
+/** \file */
+
+namespace ilang{
+	/**
+	 * \brief Running totals of the memory used by each kind of type
+	 *
+	 * Every set of counters is guarded by the lock its types are created under, so they are only
+	 * written by its holder and \ref add needs no read-modify-write; reports read them without a lock.
+	 **/
+	struct TypeMemoryCounters{
+		struct Kind{
+			std::atomic<std::size_t> numTypes{0};
+
+			//! Inner type, ancestor and child id arrays
+			std::atomic<std::size_t> innerTypeBytes{0};
+
+			//! Display and mangled name strings, once rendered
+			std::atomic<std::size_t> nameBytes{0};
+		};
+
+		//! Add \p n to \p counter, holding the lock guarding it
+		static void add(std::atomic<std::size_t> &counter, std::size_t n) noexcept{
+			counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+		}
+
+		//! Indexed by \ref TypeKind
+		Kind kinds[numTypeKinds];
+	};
+
+	//! Memory used by a \ref TypeData, attributed to the kinds of types that use it
+	struct TypeMemoryReport{
+		struct Kind{
+			std::size_t numTypes = 0;
+
+			//! \ref Type nodes
+			std::size_t nodeBytes = 0;
+
+			//! Inner type, ancestor and child id arrays
+			std::size_t innerTypeBytes = 0;
+
+			//! Display and mangled name strings, once rendered
+			std::size_t nameBytes = 0;
+
+			//! Rows of \ref TypeData::storage and \ref TypeData::table
+			std::size_t tableBytes = 0;
+
+			/**
+			 * \brief Share of the tables types of this kind are interned in
+			 *
+			 * The structural interner is shared by every compound kind and split between them by their number of types.
+			 **/
+			std::size_t internBytes = 0;
+
+			std::size_t totalBytes() const noexcept{ return nodeBytes + innerTypeBytes + nameBytes + tableBytes + internBytes; }
+		};
+
+		//! Indexed by \ref TypeKind
+		Kind kinds[numTypeKinds];
+
+		//! Name indices and string pool slots, shared by every kind
+		std::size_t nameIndexBytes = 0;
+
+		//! Reserved in arena slabs but not used by any type, e.g. the free tail of each slab
+		std::size_t unusedBytes = 0;
+
+		//! Every byte above
+		std::size_t totalBytes = 0;
+
+		const Kind &operator[](TypeKind kind) const noexcept{ return kinds[static_cast<std::size_t>(kind)]; }
+	};
+
+	/**
+	 * \brief Report the memory used by \p data
+	 *
+	 * Sums running totals kept as types are created, taking time proportional to the number of shards
+	 * and table versions, not types, so it is cheap enough to poll; it may be called while other threads use \p data.
+	 *
+	 * \param walkTypes Count every type instead, to validate the running totals; no type can be created
+	 * until the walk is done
+	 **/
+	TypeMemoryReport getTypeMemoryReport(const TypeData &data, bool walkTypes = false);
+}
+
+#endif // !ILANG_TYPEMEMORY_HPP
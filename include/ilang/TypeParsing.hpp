@@ -0,0 +1,49 @@
+#ifndef ILANG_TYPEPARSING_HPP
+#define ILANG_TYPEPARSING_HPP 1
+
+#include <string_view>
+
+#include "Type.hpp"
+
+/** \file */
+
+namespace ilang{
+	/**
+	 * \defgroup TypeParsing Type parsing
+	 * \brief Functions for getting a type from its display name
+	 *
+	 * Parses the names rendered by \ref getTypeName, as well as aliases from \ref TypeData::typeAliases
+	 * and sized aliases of number families (e.g. \c Int12 for \c Integer12):
+	 *
+	 * \code
+	 * type    := sum ('->' sum)*                   function of every sum but the last, returning the last
+	 * sum     := product ('|' product)*
+	 * product := primary ('*' primary)*
+	 * primary := name
+	 *          | '(' ('Tree' | 'List' | 'Array' | 'DynamicArray') type ')'
+	 *          | '(' 'StaticArray' type N ')'
+	 *          | '(' type ')'
+	 * name    := alias | root name | family name N | 'Partial' N | 'AsciiString' | 'Utf8String'
+	 * N       := '0' | [1-9][0-9]*
+	 * \endcode
+	 *
+	 * Inner types are not parenthesized in display names, so a function, sum or product nested
+	 * directly in another one renders the same as a flat one; such names parse as the flat type
+	 * and nested ones must be written with parentheses.
+	 *
+	 * Inner types are parsed on the stack, only lists of more than 16 of them allocate;
+	 * if that allocation fails, \ref findParsedType returns nullptr.
+	 * \returns The type or nullptr if the name is malformed or, when finding, the type does not exist.
+	 * \{
+	 **/
+
+	//! Find the type named \p str
+	TypeHandle findParsedType(const TypeData &data, std::string_view str) noexcept;
+
+	//! Get the type named \p str, creating it and its inner types if required
+	TypeHandle getParsedType(TypeData &data, std::string_view str);
+
+	/** \} */
+}
+
+#endif // !ILANG_TYPEPARSING_HPP
@@ -0,0 +1,221 @@
+#ifndef ILANG_TYPERECORDING_HPP
+#define ILANG_TYPERECORDING_HPP 1
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <vector>
+
+/** \file */
+
+/**
+ * \brief List every recorded call as CALL(name, arguments, result)
+ *
+ * Each letter of the arguments is one encoded argument: \c t a type id, \c v a list of type ids,
+ * \c n a number, \c o an optional number (zero for none, the value plus one otherwise), \c s a string,
+ * \c k a \ref ilang::TypeKey and \c r a type record (see \ref ilang::writeTypeRecord).
+ * The result is \c t for a type id (zero for none, the id plus one otherwise), \c b for a bool or \c - for none.
+ *
+ * \c type and \c alias are not functions: they recreate types and aliases the recorded calls depend on,
+ * e.g. types that existed when recording started or that were reached by following inner types.
+ **/
+#define ILANG_TYPES_CALLS(CALL)\
+	CALL(type, "r", 't')\
+	CALL(alias, "st", '-')\
+	CALL(getTypeName, "t", '-')\
+	CALL(getMangledName, "t", '-')\
+	CALL(hasBaseType, "tt", 'b')\
+	CALL(findTypeByString, "s", 't')\
+	CALL(findTypeByMangled, "s", 't')\
+	CALL(findCommonType, "tt", 't')\
+	CALL(findPartialType, "o", 't')\
+	CALL(findStringType, "o", 't')\
+	CALL(findTreeType, "t", 't')\
+	CALL(findListType, "t", 't')\
+	CALL(findArrayType, "t", 't')\
+	CALL(findDynamicArrayType, "t", 't')\
+	CALL(findStaticArrayType, "tn", 't')\
+	CALL(findComplexType, "n", 't')\
+	CALL(findImaginaryType, "n", 't')\
+	CALL(findRealType, "n", 't')\
+	CALL(findRationalType, "n", 't')\
+	CALL(findIntegerType, "n", 't')\
+	CALL(findNaturalType, "n", 't')\
+	CALL(findBooleanType, "n", 't')\
+	CALL(findSumType, "v", 't')\
+	CALL(findProductType, "v", 't')\
+	CALL(findFunctionType, "vt", 't')\
+	CALL(findCompoundType, "k", 't')\
+	CALL(getPartialType, "", 't')\
+	CALL(getStringType, "o", 't')\
+	CALL(getTreeType, "t", 't')\
+	CALL(getListType, "t", 't')\
+	CALL(getArrayType, "t", 't')\
+	CALL(getDynamicArrayType, "t", 't')\
+	CALL(getStaticArrayType, "tn", 't')\
+	CALL(getComplexType, "n", 't')\
+	CALL(getImaginaryType, "n", 't')\
+	CALL(getRealType, "n", 't')\
+	CALL(getRationalType, "n", 't')\
+	CALL(getIntegerType, "n", 't')\
+	CALL(getNaturalType, "n", 't')\
+	CALL(getBooleanType, "n", 't')\
+	CALL(getFunctionType, "vt", 't')\
+	CALL(getSumType, "v", 't')\
+	CALL(getProductType, "v", 't')\
+	CALL(findDemangledType, "s", 't')\
+	CALL(getDemangledType, "s", 't')\
+	CALL(findParsedType, "s", 't')\
+	CALL(getParsedType, "s", 't')
+
+namespace ilang{
+	struct TypeData;
+	struct FileWriter;
+
+	//! Version of the binary format written by \ref startTypeRecording, bumped on every incompatible change
+	constexpr std::uint32_t typeRecordingFormatVersion = 1;
+
+	//! Recorded call, see \ref ILANG_TYPES_CALLS
+	enum class TypeCall: std::uint8_t{
+	#define ILANG_TYPES_CALL_ENUM(name, args, result) name,
+		ILANG_TYPES_CALLS(ILANG_TYPES_CALL_ENUM)
+	#undef ILANG_TYPES_CALL_ENUM
+	};
+
+	//! Number of \ref TypeCall values
+	constexpr std::size_t numTypeCalls = static_cast<std::size_t>(TypeCall::getParsedType) + 1;
+
+	//! Name of the function \p call records
+	const char *getTypeCallName(TypeCall call) noexcept;
+
+	/**
+	 * \brief Writer of the calls made on a \ref TypeData, see \ref startTypeRecording
+	 *
+	 * Calls from every thread are appended under \ref mutex in the order they return.
+	 **/
+	struct TypeRecorder{
+		explicit TypeRecorder(int fd);
+		~TypeRecorder();
+
+		std::mutex mutex;
+		std::unique_ptr<FileWriter> writer;
+
+		//! Whether the type with each id was produced by a recorded call, so later calls may refer to it
+		std::vector<bool> recorded;
+
+		//! Number of calls recorded, including \ref TypeCall::type and \ref TypeCall::alias
+		std::uint64_t numCalls = 0;
+
+		//! First error writing the recording, nothing more is recorded after it
+		std::error_code error;
+	};
+
+	/**
+	 * \brief Start recording every public call on \p data to \p fd
+	 *
+	 * Records the types and aliases \p data already has first, so the recording replays onto a fresh \ref TypeData.
+	 * Calls are only recorded when \c ILANG_TYPES_RECORDING is defined for the library and every user of it,
+	 * e.g. by configuring with \c -DILANG_TYPES_ENABLE_RECORDING=ON. Calls made by other public functions
+	 * are not recorded, neither are functions that only test flags or return a prelude type.
+	 *
+	 * \p data must not be used by other threads, moved or have aliases added while recording is started or stopped.
+	 * \throws std::runtime_error if recording is not compiled in or already started
+	 * \throws std::system_error if writing fails
+	 **/
+	void startTypeRecording(TypeData &data, int fd);
+
+	/**
+	 * \brief Stop recording calls on \p data and flush the recording
+	 *
+	 * \returns The number of calls recorded
+	 * \throws std::system_error if writing the recording failed at any point
+	 **/
+	std::uint64_t stopTypeRecording(TypeData &data);
+
+	//! Calls read from a recording, see \ref readTypeWorkload
+	struct TypeWorkload{
+		struct Call{
+			TypeCall call;
+
+			//! Index of the first argument in \ref args, arguments run up to the next call's
+			std::size_t firstArg;
+
+			//! Encoded result, see \ref ILANG_TYPES_CALLS
+			std::uint64_t result;
+		};
+
+		//! Number of types in the prelude of the recorded data
+		std::size_t numPreludeTypes = 0;
+
+		//! \ref hashPrelude of the recorded data
+		std::uint64_t preludeHash = 0;
+
+		//! Number of leading calls recreating the types and aliases the data had when recording started
+		std::size_t numSetupCalls = 0;
+
+		//! One more than the highest type id a call refers to
+		std::size_t numTypeIds = 0;
+
+		std::vector<Call> calls;
+
+		//! Decoded arguments of every call; lists are prefixed with their size, strings are an offset and size into \ref strings
+		std::vector<std::uint64_t> args;
+
+		std::string strings;
+	};
+
+	/**
+	 * \brief Read a recording written by \ref startTypeRecording from \p fd
+	 *
+	 * A call torn by a crash while it was recorded is left out.
+	 * \throws std::runtime_error if the recording is malformed, of another format version or refers to a type before it was produced
+	 * \throws std::system_error if reading fails
+	 **/
+	TypeWorkload readTypeWorkload(int fd);
+
+	//! Options of \ref replayTypeWorkload
+	struct TypeReplayOptions{
+		/**
+		 * \brief Threads the calls after the setup are partitioned across
+		 *
+		 * Calls are dealt out in chunks of \ref callsPerChunk, a call using a type produced by another thread waits for it.
+		 * More than one thread requires a \ref TypeDataOptions::concurrent data.
+		 **/
+		std::size_t numThreads = 1;
+
+		std::size_t callsPerChunk = 256;
+	};
+
+	//! Outcome of \ref replayTypeWorkload
+	struct TypeReplayResult{
+		//! Calls replayed after the setup
+		std::uint64_t numCalls = 0;
+
+		/**
+		 * \brief Calls whose result was a type, or true, when recorded but not when replayed or the other way around
+		 *
+		 * Partitioned replays may have some: a find can run before another thread created the type it found when recorded.
+		 * Sequential replays of calls recorded from several threads may too, as a call is logged when it returns,
+		 * so a find can be logged before the call that created the type it found.
+		 **/
+		std::uint64_t numMismatches = 0;
+
+		std::chrono::nanoseconds setupTime{0}, time{0};
+	};
+
+	/**
+	 * \brief Make every call of \p workload again on \p data
+	 *
+	 * Types are passed by what the replayed calls returned, so the ids of \p data need not match the recorded ones.
+	 * \p data must have the same prelude as the recorded data, usually it is freshly constructed.
+	 * \throws std::runtime_error if the prelude differs or the options are invalid
+	 * \throws std::system_error if a replay thread can not be started, once the started ones gave up
+	 **/
+	TypeReplayResult replayTypeWorkload(const TypeWorkload &workload, TypeData &data, const TypeReplayOptions &options = {});
+}
+
+#endif // !ILANG_TYPERECORDING_HPP
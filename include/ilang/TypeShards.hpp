@@ -0,0 +1,112 @@
+#ifndef ILANG_TYPESHARDS_HPP
+#define ILANG_TYPESHARDS_HPP 1
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "NameIndex.hpp"
+#include "StringPool.hpp"
+#include "TypeArena.hpp"
+#include "TypeInterner.hpp"
+#include "TypeMemory.hpp"
+#include "TypeTable.hpp"
+
+/** \file */
+
+namespace ilang{
+	/**
+	 * \brief Independently locked part of a concurrent interner
+	 *
+	 * Holds the compound types whose structural hash selects this shard, and the memory for them.
+	 **/
+	struct alignas(64) TypeShard{
+		std::mutex mutex;
+		TypeInterner interner;
+		TypeArena arena;
+
+		//! Ids of types interned here whose names were not rendered and indexed yet, see \ref TypeData::lazyNames
+		std::vector<TypeId> unindexed;
+
+		//! Size of \ref unindexed plus ids taken from it but not indexed yet, readable without \ref mutex
+		std::atomic<std::size_t> numUnindexed{0};
+
+		//! Memory used by the types interned here, written under \ref mutex
+		TypeMemoryCounters memory;
+	};
+
+	/**
+	 * \brief Independently locked part of the name indices of a concurrent \ref TypeData
+	 *
+	 * Indexes the names whose hash selects this shard. \ref mutex also guards the name columns
+	 * of \ref TypeData::table for the ids that select this shard.
+	 **/
+	struct alignas(64) NameShard{
+		std::mutex mutex;
+		NameIndex nameIndex, mangledIndex;
+
+		//! Names rendered for the ids that select this shard
+		std::size_t numRenderedNames = 0;
+
+		//! Bytes of the names rendered for the ids that select this shard, written under \ref mutex
+		TypeMemoryCounters memory;
+	};
+
+	//! Independently locked part of the strings of a concurrent \ref TypeData
+	struct alignas(64) StringShard{
+		std::mutex mutex;
+		StringPool strings;
+	};
+
+	/**
+	 * \brief Synchronization state of a \ref TypeData shared between threads
+	 *
+	 * Locks only serialize writers, find functions never take them.
+	 * Lock order is \ref indexMutex, then a type shard, then a name shard, then a string shard;
+	 * \ref mapsMutex is only held together with type shards by a getTypeMemoryReport walking the types, which
+	 * takes it after every one of them, and otherwise at most one shard of each kind is held.
+	 **/
+	struct TypeShards{
+		explicit TypeShards(std::size_t n)
+			: shards(new TypeShard[n]), nameShards(new NameShard[n]), stringShards(new StringShard[n]), numShards(n){}
+
+		//! Shard for a compound type with structural hash \p keyHash
+		TypeShard &shardFor(std::uint64_t keyHash) noexcept{
+			// interners index with the low bits, so shards are picked with the high ones
+			return shards[(keyHash >> 32) & (numShards - 1)];
+		}
+
+		//! Shard indexing a name with \p nameHash, see \ref NameIndex::hash
+		NameShard &nameShardFor(std::uint64_t nameHash) noexcept{
+			return nameShards[(nameHash >> 32) & (numShards - 1)];
+		}
+
+		//! Shard guarding the name columns of the type \p id
+		NameShard &nameShardForId(TypeId id) noexcept{
+			return nameShards[id & (numShards - 1)];
+		}
+
+		//! Shard holding a string with \p strHash, see \ref StringPool::hash
+		StringShard &stringShardFor(std::uint64_t strHash) noexcept{
+			return stringShards[(strHash >> 32) & (numShards - 1)];
+		}
+
+		std::unique_ptr<TypeShard[]> shards;
+		std::unique_ptr<NameShard[]> nameShards;
+		std::unique_ptr<StringShard[]> stringShards;
+		std::size_t numShards;
+
+		//! Next free \ref TypeId
+		std::atomic<TypeId> nextId{0};
+
+		//! Guards the sized number, encoded string and partial type tables and \ref TypeData::arena
+		std::mutex mapsMutex;
+
+		//! Serializes lookups indexing the names of \ref TypeShard::unindexed types
+		std::mutex indexMutex;
+	};
+}
+
+#endif // !ILANG_TYPESHARDS_HPP
@@ -0,0 +1,111 @@
+#ifndef ILANG_TYPESTATS_HPP
+#define ILANG_TYPESTATS_HPP 1
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/** \file */
+
+/**
+ * \brief Evaluate the arguments only when statistics are compiled in
+ *
+ * Statistics are counted when \c ILANG_TYPES_STATS is defined for the library and every user of it,
+ * e.g. by configuring with \c -DILANG_TYPES_ENABLE_STATS=ON; otherwise counting compiles to nothing.
+ **/
+#ifdef ILANG_TYPES_STATS
+	#define ILANG_TYPES_COUNT(...) do{ __VA_ARGS__; } while(0)
+#else
+	#define ILANG_TYPES_COUNT(...) do{} while(0)
+#endif
+
+namespace ilang{
+	struct TypeData;
+	enum class TypeKind: std::uint8_t;
+
+	//! Number of \ref TypeKind values, checked where the enum is defined
+	constexpr std::size_t numTypeKinds = 14;
+
+	/**
+	 * \brief Live statistics counters of a \ref TypeData
+	 *
+	 * Counted with relaxed atomics, so they are safe to update from every thread
+	 * but only consistent with each other once the threads are done.
+	 **/
+	struct TypeCounters{
+		//! Outcomes of get functions for one kind of type
+		struct Kind{
+			//! Calls that found an existing type, including one another thread created while the call waited for a lock
+			std::atomic<std::uint64_t> hits{0};
+
+			//! Calls that did not find the type, even under the lock
+			std::atomic<std::uint64_t> misses{0};
+
+			//! Types created, at most one per miss
+			std::atomic<std::uint64_t> creations{0};
+		};
+
+		//! Calls of a name lookup
+		struct Lookup{
+			std::atomic<std::uint64_t> calls{0}, hits{0}, nanoseconds{0};
+		};
+
+		//! Indexed by \ref TypeKind
+		Kind kinds[numTypeKinds];
+
+		Lookup stringLookups, mangledLookups;
+	};
+
+	/**
+	 * \brief Counters of \ref hasBaseType
+	 *
+	 * Process wide, because handles are checked without their \ref TypeData.
+	 **/
+	struct BaseTypeCounters{
+		std::atomic<std::uint64_t> checks{0};
+
+		//! Ancestors compared, at most one per check since ancestors are indexed by depth
+		std::atomic<std::uint64_t> steps{0};
+	};
+
+#ifdef ILANG_TYPES_STATS
+	extern BaseTypeCounters baseTypeCounters;
+#endif
+
+	//! Snapshot of the statistics of a \ref TypeData
+	struct TypeStats{
+		struct Kind{
+			std::uint64_t hits = 0, misses = 0, creations = 0;
+		};
+
+		struct Lookup{
+			std::uint64_t calls = 0, hits = 0, nanoseconds = 0;
+		};
+
+		//! Whether the library was built with statistics, every count is zero otherwise
+		bool enabled = false;
+
+		//! Outcomes of get functions, indexed by \ref TypeKind
+		Kind kinds[numTypeKinds];
+
+		//! Calls of \ref findTypeByString and \ref findTypeByMangled, and the time spent in them
+		Lookup stringLookups, mangledLookups;
+
+		//! Calls of \ref hasBaseType in the whole process and the ancestors they compared
+		std::uint64_t baseTypeChecks = 0, baseTypeSteps = 0;
+
+		//! Bytes allocated for type nodes, inner types and names
+		std::size_t bytesAllocated = 0;
+
+		const Kind &operator[](TypeKind kind) const noexcept{ return kinds[static_cast<std::size_t>(kind)]; }
+	};
+
+	/**
+	 * \brief Take a snapshot of the statistics of \p data
+	 *
+	 * Safe to call while other threads use \p data; their latest counts may be missing.
+	 **/
+	TypeStats getTypeStats(const TypeData &data);
+}
+
+#endif // !ILANG_TYPESTATS_HPP
@@ -0,0 +1,63 @@
+#ifndef ILANG_TYPETABLE_HPP
+#define ILANG_TYPETABLE_HPP 1
+
+#include <cstdint>
+#include <limits>
+
+#include "SegmentedVector.hpp"
+#include "StringPool.hpp"
+#include "TypeArena.hpp"
+
+/** \file */
+
+namespace ilang{
+	struct Type;
+	enum class TypeKind: std::uint8_t;
+
+	//! \brief Used for type comparisons
+	using TypeHandle = const Type*;
+
+	/**
+	 * \brief Dense type identifier
+	 *
+	 * Identifiers are handed out in creation order, so a type's id is its index in \ref TypeData::storage.
+	 **/
+	using TypeId = std::uint32_t;
+
+	//! Id that never refers to a type
+	constexpr TypeId invalidTypeId = std::numeric_limits<TypeId>::max();
+
+	/**
+	 * \brief Struct-of-arrays view of every type in a \ref TypeData
+	 *
+	 * Row \c i of every column describes the type with id \c i.
+	 * Columns are segmented, so rows for different ids may be stored by different threads at once.
+	 **/
+	struct TypeTable{
+		//! Number of rows in the table
+		std::size_t size() const noexcept{ return bases.size(); }
+
+		//! Inner types of the type \p id
+		Span<const TypeId> childrenOf(TypeId id) const noexcept{ return children[id]; }
+
+		//! Store the row for \p type, allocating its child ids from \p arena
+		void store(TypeHandle type, TypeArena &arena);
+
+		SegmentedVector<TypeId> bases;
+
+		//! Number of refinements between Infinity and the type
+		SegmentedVector<std::uint32_t> depths;
+
+		SegmentedVector<TypeKind> kinds;
+		SegmentedVector<std::uint32_t> flags;
+		SegmentedVector<std::uint64_t> params;
+
+		//! Ids of the inner types of the type
+		SegmentedVector<Span<const TypeId>> children;
+
+		//! Names are filled in when they are rendered
+		mutable SegmentedVector<InternedString> names, mangledNames;
+	};
+}
+
+#endif // !ILANG_TYPETABLE_HPP
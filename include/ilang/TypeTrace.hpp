@@ -0,0 +1,93 @@
+#ifndef ILANG_TYPETRACE_HPP
+#define ILANG_TYPETRACE_HPP 1
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+/** \file */
+
+/**
+ * \brief Trace the rest of the enclosing scope as an operation called \p name
+ *
+ * Operations are traced when \c ILANG_TYPES_TRACING is defined for the library and every user of it,
+ * e.g. by configuring with \c -DILANG_TYPES_ENABLE_TRACING=ON, and a trace was started with
+ * \ref startTypeTrace; otherwise tracing compiles to nothing.
+ * \p name must be a string literal.
+ **/
+#ifdef ILANG_TYPES_TRACING
+	#define ILANG_TYPES_TRACE(name) ::ilang::TypeTraceScope ilangTypeTraceScope_(name)
+#else
+	#define ILANG_TYPES_TRACE(name) do{} while(0)
+#endif
+
+namespace ilang{
+	//! Options of \ref startTypeTrace
+	struct TypeTraceOptions{
+		//! Operations kept per thread, older ones are overwritten; fixed when a thread is first traced or reuses the buffer of an exited one
+		std::size_t eventsPerThread = 64 * 1024;
+
+		//! Operations taking at least this long are logged to \ref slowLog as they finish, zero logs none
+		std::chrono::nanoseconds slowThreshold{0};
+
+		//! Where slow operations are logged
+		std::FILE *slowLog = stderr;
+	};
+
+	//! Whether a trace is being recorded
+	extern std::atomic<bool> typeTraceActive;
+
+	//! Record an operation called \p name that started \p start nanoseconds into the trace
+	void recordTypeTraceEvent(const char *name, std::uint64_t start) noexcept;
+
+	//! Nanoseconds since the current trace was started
+	std::uint64_t typeTraceClock() noexcept;
+
+	/**
+	 * \brief Records the lifetime of a scope, see \ref ILANG_TYPES_TRACE
+	 *
+	 * Costs a relaxed load when no trace is being recorded.
+	 **/
+	struct TypeTraceScope{
+		explicit TypeTraceScope(const char *name_) noexcept
+			: name(typeTraceActive.load(std::memory_order_relaxed) ? name_ : nullptr)
+			, start(name ? typeTraceClock() : 0)
+		{}
+
+		~TypeTraceScope(){
+			if(name)
+				recordTypeTraceEvent(name, start);
+		}
+
+		TypeTraceScope(const TypeTraceScope&) = delete;
+		TypeTraceScope &operator=(const TypeTraceScope&) = delete;
+
+		const char *name;
+		std::uint64_t start;
+	};
+
+	/**
+	 * \brief Start recording a trace, discarding any previous one
+	 *
+	 * Each thread records into its own ring buffer without locking, once it registered the buffer on its first traced operation.
+	 * The buffer of a thread that exits is reused by the next thread registering one, so its operations share a \c tid.
+	 **/
+	void startTypeTrace(const TypeTraceOptions &options = {});
+
+	//! Stop recording; the trace is kept until the next \ref startTypeTrace
+	void stopTypeTrace() noexcept;
+
+	/**
+	 * \brief Write the operations recorded by the current or last trace to \p path in Chrome trace event format
+	 *
+	 * The file can be loaded by \c chrome://tracing or Perfetto. May be called while recording;
+	 * operations overwritten while they are written are left out.
+	 *
+	 * \returns The number of operations written
+	 * \throws std::system_error if the file can not be written
+	 **/
+	std::size_t writeTypeTrace(const char *path);
+}
+
+#endif // !ILANG_TYPETRACE_HPP
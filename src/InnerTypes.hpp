@@ -0,0 +1,46 @@
+#ifndef ILANG_SRC_INNERTYPES_HPP
+#define ILANG_SRC_INNERTYPES_HPP 1
+
+#include <cstddef>
+#include <vector>
+
+#include "ilang/Type.hpp"
+
+namespace ilang{
+	/**
+	 * \brief Inner types of a type being decoded
+	 *
+	 * Held on the stack, only allocating for unusually many.
+	 **/
+	struct InnerTypes{
+		static constexpr std::size_t numInlineTypes = 16;
+
+		void push(TypeHandle type){
+			if(n < numInlineTypes)
+				inlineTypes[n] = type;
+			else{
+				if(more.empty())
+					more.assign(inlineTypes, inlineTypes + numInlineTypes);
+
+				more.emplace_back(type);
+			}
+
+			++n;
+		}
+
+		TypeHandle *data() noexcept{ return n <= numInlineTypes ? inlineTypes : more.data(); }
+		std::size_t size() const noexcept{ return n; }
+		bool empty() const noexcept{ return n == 0; }
+
+		TypeHandle back() noexcept{ return data()[n - 1]; }
+		void pop_back() noexcept{ if(n-- > numInlineTypes) more.pop_back(); }
+
+		std::vector<TypeHandle> vector(){ return std::vector<TypeHandle>(data(), data() + n); }
+
+		TypeHandle inlineTypes[numInlineTypes];
+		std::vector<TypeHandle> more;
+		std::size_t n = 0;
+	};
+}
+
+#endif // !ILANG_SRC_INNERTYPES_HPP
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <functional>
+
+#include "ilang/NameIndex.hpp"
+
+using namespace ilang;
+
+namespace {
+	constexpr std::size_t minIndexCapacity = 64;
+
+	//! Bloom filter probes per name
+	constexpr std::uint32_t numFilterProbes = 3;
+
+	//! Bits of filter per slot of the table, ~10 bits per name at the maximum load factor
+	constexpr std::size_t filterBitsPerSlot = 8;
+
+	template<typename Fn>
+	void forEachFilterBit(std::uint64_t nameHash, std::size_t numBits, Fn &&fn) noexcept{
+		// double hashing with the two halves of the name hash
+		auto h1 = static_cast<std::uint32_t>(nameHash);
+		auto h2 = static_cast<std::uint32_t>(nameHash >> 32) | 1;
+		auto mask = numBits - 1;
+
+		for(std::uint32_t i = 0; i < numFilterProbes; i++)
+			fn((h1 + i * h2) & mask);
+	}
+}
+
+std::uint64_t NameIndex::hash(std::string_view name) noexcept{
+	return std::hash<std::string_view>{}(name);
+}
+
+NameIndex::Table::Table(std::size_t n)
+	: capacity(n), slots(new std::atomic<Slot>[n]), filter(new std::atomic<std::uint64_t>[n * filterBitsPerSlot / 64])
+{
+	for(std::size_t i = 0; i < n; i++)
+		slots[i].store(emptySlot, std::memory_order_relaxed);
+
+	for(std::size_t i = 0; i < n * filterBitsPerSlot / 64; i++)
+		filter[i].store(0, std::memory_order_relaxed);
+}
+
+bool NameIndex::mayContain(const Table &tbl, std::uint64_t nameHash) noexcept{
+	bool res = true;
+
+	forEachFilterBit(nameHash, tbl.capacity * filterBitsPerSlot, [&](std::size_t bit){
+		res = res && (tbl.filter[bit / 64].load(std::memory_order_relaxed) & (std::uint64_t(1) << (bit % 64)));
+	});
+
+	return res;
+}
+
+void NameIndex::addToFilter(Table &tbl, std::uint64_t nameHash) noexcept{
+	forEachFilterBit(nameHash, tbl.capacity * filterBitsPerSlot, [&](std::size_t bit){
+		// only the (single) writer modifies the filter
+		auto &&word = tbl.filter[bit / 64];
+		word.store(word.load(std::memory_order_relaxed) | (std::uint64_t(1) << (bit % 64)), std::memory_order_relaxed);
+	});
+}
+
+TypeId NameIndex::find(const SegmentedVector<InternedString> &names, std::string_view name, std::uint64_t nameHash) const noexcept{
+	auto tbl = table.load();
+	if(!tbl)
+		return invalidTypeId;
+
+	if(!mayContain(*tbl, nameHash))
+		return invalidTypeId;
+
+	auto mask = tbl->capacity - 1;
+	auto hash32 = static_cast<std::uint32_t>(nameHash);
+
+	for(auto i = hash32 & mask; ; i = (i + 1) & mask){
+		auto slot = tbl->slots[i].load(std::memory_order_acquire);
+		auto id = static_cast<TypeId>(slot);
+
+		if(id == invalidTypeId)
+			return invalidTypeId;
+		else if(static_cast<std::uint32_t>(slot >> 32) == hash32 && names[id] == name)
+			return id;
+	}
+}
+
+void NameIndex::insert(const SegmentedVector<InternedString> &names, TypeId id, std::uint64_t nameHash){
+	reserve(names, count + 1);
+
+	auto tbl = table.load();
+	auto name = names[id];
+	auto mask = tbl->capacity - 1;
+	auto hash32 = static_cast<std::uint32_t>(nameHash);
+	auto i = hash32 & mask;
+
+	for(Slot slot; (slot = tbl->slots[i].load(std::memory_order_relaxed)) != emptySlot; i = (i + 1) & mask){
+		// names from the same pool are equal exactly when their handles are
+		if(static_cast<std::uint32_t>(slot >> 32) == hash32 && names[static_cast<TypeId>(slot)] == name)
+			return;
+	}
+
+	// the filter bits are set before the slot is published
+	addToFilter(*tbl, nameHash);
+	tbl->slots[i].store(Slot(hash32) << 32 | id, std::memory_order_release);
+	++count;
+}
+
+void NameIndex::reserve(const SegmentedVector<InternedString> &names, std::size_t n){
+	auto old = table.load();
+
+	// keep the load factor at or below 3/4
+	auto required = n + n / 3 + 1;
+	if(old && required <= old->capacity)
+		return;
+
+	auto capacity = std::max(old ? old->capacity * 2 : 0, minIndexCapacity);
+	while(capacity < required)
+		capacity *= 2;
+
+	auto tbl = std::make_unique<Table>(capacity);
+	auto mask = capacity - 1;
+
+	for(std::size_t j = 0; old && j < old->capacity; j++){
+		auto slot = old->slots[j].load(std::memory_order_relaxed);
+		if(slot == emptySlot) continue;
+
+		auto i = static_cast<std::uint32_t>(slot >> 32) & mask;
+		while(tbl->slots[i].load(std::memory_order_relaxed) != emptySlot)
+			i = (i + 1) & mask;
+
+		tbl->slots[i].store(slot, std::memory_order_relaxed);
+		addToFilter(*tbl, hash(names[static_cast<TypeId>(slot)]));
+	}
+
+	table.publish(std::move(tbl));
+}
+
+std::size_t NameIndex::bytesAllocated() const noexcept{
+	std::size_t n = 0;
+	table.forEachVersion([&n](const Table &tbl){ n += sizeof(Table) + sizeof(Slot) * tbl.capacity + tbl.capacity * filterBitsPerSlot / 8; });
+	return n;
+}
@@ -0,0 +1,96 @@
+#ifndef ILANG_RECORDCALL_HPP
+#define ILANG_RECORDCALL_HPP 1
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "ilang/Type.hpp"
+#include "ilang/TypeRecording.hpp"
+
+/**
+ * \brief Record the enclosing public function as a call on \p data, see \ref ILANG_TYPES_RECORD
+ *
+ * Calls are recorded when \c ILANG_TYPES_RECORDING is defined, otherwise this compiles to nothing.
+ **/
+#ifdef ILANG_TYPES_RECORDING
+	#define ILANG_TYPES_RECORD_CALL(data) ::ilang::RecordScope ilangRecordScope_(data)
+	#define ILANG_TYPES_RECORD(...) do{ if(ilangRecordScope_.recorder) ::ilang::recordCall(*ilangRecordScope_.recorder, __VA_ARGS__); } while(0)
+#else
+	#define ILANG_TYPES_RECORD_CALL(data) do{} while(0)
+	#define ILANG_TYPES_RECORD(...) do{} while(0)
+#endif
+
+namespace ilang{
+#ifdef ILANG_TYPES_RECORDING
+	//! Finds the recorder of a public call, unless it was made by another public function
+	struct RecordScope{
+		explicit RecordScope(const TypeData &data) noexcept
+			: counted(data.recorder != nullptr)
+			, recorder(counted && depth++ == 0 ? data.recorder.get() : nullptr)
+		{}
+
+		~RecordScope(){
+			if(counted)
+				--depth;
+		}
+
+		RecordScope(const RecordScope&) = delete;
+		RecordScope &operator=(const RecordScope&) = delete;
+
+		bool counted;
+		TypeRecorder *recorder;
+
+		//! Public calls on a recorded data the current thread is in
+		inline static thread_local std::size_t depth = 0;
+	};
+#endif
+
+	//! Record the types in an argument before the call, if no earlier call produced them
+	void prepareCallArg(TypeRecorder &recorder, TypeHandle type);
+	void prepareCallArg(TypeRecorder &recorder, const std::vector<TypeHandle> &types);
+	void prepareCallArg(TypeRecorder &recorder, const TypeKey &key);
+
+	template<typename T>
+	void prepareCallArg(TypeRecorder&, const T&){}
+
+	void beginCall(TypeRecorder &recorder, TypeCall call);
+
+	void writeCallArg(TypeRecorder &recorder, TypeHandle type);
+	void writeCallArg(TypeRecorder &recorder, const std::vector<TypeHandle> &types);
+	void writeCallArg(TypeRecorder &recorder, const TypeKey &key);
+	void writeCallArg(TypeRecorder &recorder, std::uint64_t n);
+	void writeCallArg(TypeRecorder &recorder, std::optional<std::uint32_t> n);
+	void writeCallArg(TypeRecorder &recorder, std::optional<StringEncoding> encoding);
+	void writeCallArg(TypeRecorder &recorder, std::string_view str);
+
+	void finishCall(TypeRecorder &recorder, TypeHandle result);
+	void finishCall(TypeRecorder &recorder, bool result);
+
+	/**
+	 * \brief Append a call of \p call with \p args that returned \p result
+	 *
+	 * Errors are kept in \ref TypeRecorder::error and stop the recording, the recorded call itself never fails.
+	 **/
+	template<typename Result, typename ... Args>
+	void recordCall(TypeRecorder &recorder, TypeCall call, Result result, const Args &... args) noexcept{
+		std::lock_guard<std::mutex> lock(recorder.mutex);
+		if(recorder.error)
+			return;
+
+		try{
+			(prepareCallArg(recorder, args), ...);
+			beginCall(recorder, call);
+			(writeCallArg(recorder, args), ...);
+			finishCall(recorder, result);
+		}
+		catch(const std::system_error &err){
+			recorder.error = err.code();
+		}
+		catch(...){
+			recorder.error = std::make_error_code(std::errc::not_enough_memory);
+		}
+	}
+}
+
+#endif // !ILANG_RECORDCALL_HPP
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <functional>
+
+#include "ilang/StringPool.hpp"
+
+using namespace ilang;
+
+namespace {
+	constexpr std::size_t minPoolCapacity = 256;
+
+	std::size_t findSlot(const std::vector<StringPool::Slot> &slots, std::string_view str, std::uint64_t hash) noexcept{
+		auto mask = slots.size() - 1;
+
+		for(auto i = hash & mask; ; i = (i + 1) & mask){
+			auto &&slot = slots[i];
+			if(!slot.ptr)
+				return i;
+
+			if(slot.hash == hash && InternedString(slot.ptr).view() == str)
+				return i;
+		}
+	}
+
+	void growSlots(std::vector<StringPool::Slot> &slots, std::size_t n){
+		// keep the load factor at or below 3/4
+		auto required = n + n / 3 + 1;
+		if(required <= slots.size())
+			return;
+
+		auto capacity = std::max(slots.size() * 2, minPoolCapacity);
+		while(capacity < required)
+			capacity *= 2;
+
+		std::vector<StringPool::Slot> newSlots(capacity, StringPool::Slot{0, nullptr});
+		auto mask = capacity - 1;
+
+		for(auto &&slot : slots){
+			if(!slot.ptr) continue;
+
+			auto i = slot.hash & mask;
+			while(newSlots[i].ptr)
+				i = (i + 1) & mask;
+
+			newSlots[i] = slot;
+		}
+
+		slots = std::move(newSlots);
+	}
+}
+
+std::uint64_t StringPool::hash(std::string_view str) noexcept{
+	return std::hash<std::string_view>{}(str);
+}
+
+InternedString StringPool::intern(std::string_view str){
+	return intern(str, hash(str));
+}
+
+InternedString StringPool::intern(std::string_view str, std::uint64_t strHash){
+	if(str.empty())
+		return {};
+
+	growSlots(slots, count + 1);
+
+	auto &&slot = slots[findSlot(slots, str, strHash)];
+
+	if(!slot.ptr){
+		auto len = static_cast<std::uint32_t>(str.size());
+		auto mem = static_cast<char*>(arena.allocate(sizeof(len) + str.size() + 1, alignof(std::uint32_t)));
+
+		std::memcpy(mem, &len, sizeof(len));
+		std::memcpy(mem + sizeof(len), str.data(), str.size());
+		mem[sizeof(len) + str.size()] = '\0';
+
+		slot = Slot{strHash, mem + sizeof(len)};
+		++count;
+	}
+
+	return InternedString(slot.ptr);
+}
+
+InternedString StringPool::intern(std::initializer_list<std::string_view> parts){
+	scratch.clear();
+
+	for(auto part : parts)
+		scratch += part;
+
+	return intern(scratch);
+}
+
+std::optional<InternedString> StringPool::find(std::string_view str) const noexcept{
+	if(str.empty())
+		return InternedString();
+	else if(slots.empty())
+		return std::nullopt;
+
+	auto &&slot = slots[findSlot(slots, str, hash(str))];
+	if(!slot.ptr)
+		return std::nullopt;
+
+	return InternedString(slot.ptr);
+}
@@ -1,76 +1,305 @@
 #include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
 
 #include "ilang/Type.hpp"
+#include "ilang/TypeTrace.hpp"
+
+#include "RecordCall.hpp"
+#include "TypeKeys.hpp"
 
 using namespace ilang;
 
-TypeHandle createEncodedStringType(TypeData &data, StringEncoding encoding) noexcept{
-	auto type = std::make_unique<Type>();
-	type->base = data.stringType;
+//! Exclusively lock \p mutex of the shards of \p data, or nothing if \p data is not shared between threads
+template<typename Mutex>
+std::unique_lock<Mutex> writeLock(const TypeData &data, Mutex TypeShards::*mutex){
+	if(data.shards)
+		return std::unique_lock<Mutex>(data.shards.get()->*mutex);
+	else
+		return {};
+}
+
+#ifdef ILANG_TYPES_STATS
+//! Count a get of a type of \p kind in \p counter
+void countGet(const TypeData &data, TypeKind kind, std::atomic<std::uint64_t> TypeCounters::Kind::*counter) noexcept{
+	(data.counters->kinds[static_cast<std::size_t>(kind)].*counter).fetch_add(1, std::memory_order_relaxed);
+}
+#endif
+
+//! Call \p find, counting the call, whether it found a type and the time it took in \p lookup
+template<typename Find>
+TypeHandle countLookup(const TypeData &data, TypeCounters::Lookup TypeCounters::*lookup, Find &&find){
+#ifdef ILANG_TYPES_STATS
+	auto t0 = std::chrono::steady_clock::now();
+	auto res = find();
+	auto t1 = std::chrono::steady_clock::now();
+
+	auto &&counters = (*data.counters).*lookup;
+	counters.calls.fetch_add(1, std::memory_order_relaxed);
+	counters.hits.fetch_add(res ? 1 : 0, std::memory_order_relaxed);
+	counters.nanoseconds.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()), std::memory_order_relaxed);
+
+	return res;
+#else
+	(void)data; (void)lookup;
+	return find();
+#endif
+}
+
+InternedString internString(const TypeData &data, std::string_view str){
+	if(!data.shards)
+		return data.strings.intern(str);
+	else if(str.empty())
+		return {};
+
+	// equal strings always hash to the same shard, so they still get the same handle
+	auto hash = StringPool::hash(str);
+	auto &&shard = data.shards->stringShardFor(hash);
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	return shard.strings.intern(str, hash);
+}
+
+InternedString internString(const TypeData &data, std::initializer_list<std::string_view> parts){
+	if(!data.shards)
+		return data.strings.intern(parts);
+
+	std::string str;
+	for(auto part : parts)
+		str += part;
+
+	return internString(data, str);
+}
+
+Span<const TypeHandle> createInnerTypes(TypeArena &arena, const TypeHandle *types, std::size_t numTypes, TypeHandle result = nullptr){
+	auto n = numTypes + (result ? 1 : 0);
+	auto ptr = static_cast<TypeHandle*>(arena.allocate(sizeof(TypeHandle) * n, alignof(TypeHandle)));
+
+	std::copy(types, types + numTypes, ptr);
+	if(result)
+		ptr[numTypes] = result;
+
+	return {ptr, n};
+}
+
+Span<const TypeHandle> createInnerTypes(TypeArena &arena, const std::vector<TypeHandle> &types){
+	return createInnerTypes(arena, types.data(), types.size());
+}
+
+//! Add every type not yet in the display name index, rendering names if required
+void indexTypeNames(const TypeData &data){
+	for(auto id = data.numIndexedNames; id < data.storage.size(); id++){
+		getTypeName(data, data.storage[id]);
+		data.nameIndex.insert(data.table.names, static_cast<TypeId>(id));
+	}
+
+	data.numIndexedNames = data.storage.size();
+}
+
+//! Add every type not yet in the mangled name index, rendering names if required
+void indexMangledNames(const TypeData &data){
+	for(auto id = data.numIndexedMangledNames; id < data.storage.size(); id++){
+		getMangledName(data, data.storage[id]);
+		data.mangledIndex.insert(data.table.mangledNames, static_cast<TypeId>(id));
+	}
+
+	data.numIndexedMangledNames = data.storage.size();
+}
+
+//! Add the named \p type to the shard of \p index its name in \p names selects
+void indexSharedName(const TypeData &data, NameIndex NameShard::*index, const SegmentedVector<InternedString> &names, TypeHandle type){
+	auto hash = NameIndex::hash(names[type->id]);
+	auto &&shard = data.shards->nameShardFor(hash);
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	(shard.*index).insert(names, type->id, hash);
+}
+
+/**
+ * \brief Add a newly named type to the name indices, unless names are indexed on first lookup
+ *
+ * Types are indexed right away when shared between threads, as ids are not named in order;
+ * lazily named compound types are queued in their shard by \ref getInternedType instead.
+ **/
+void indexNewType(const TypeData &data, TypeHandle type){
+	if(data.shards){
+		indexSharedName(data, &NameShard::nameIndex, data.table.names, type);
+		indexSharedName(data, &NameShard::mangledIndex, data.table.mangledNames, type);
+	}
+	else if(!data.lazyNames){
+		indexTypeNames(data);
+		indexMangledNames(data);
+	}
+}
+
+/**
+ * \brief Render and index the names of every lazily named type interned by another thread so far
+ *
+ * Queued ids are only dropped from the counts once indexed, so a lookup that finds nothing
+ * queued knows every type created before it is indexed.
+ **/
+void indexQueuedTypes(const TypeData &data){
+	auto &&shards = *data.shards;
+
+	auto anyQueued = [&shards]{
+		for(std::size_t i = 0; i < shards.numShards; i++)
+			if(shards.shards[i].numUnindexed.load(std::memory_order_acquire))
+				return true;
+
+		return false;
+	};
+
+	if(!anyQueued())
+		return;
+
+	std::lock_guard<std::mutex> indexLock(shards.indexMutex);
+
+	for(std::size_t i = 0; i < shards.numShards; i++){
+		auto &&shard = shards.shards[i];
+		std::vector<TypeId> ids;
+
+		{
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			ids.swap(shard.unindexed);
+		}
+
+		for(auto id : ids){
+			auto type = data.storage[id];
+			getTypeName(data, type);
+			getMangledName(data, type);
+			indexNewType(data, type);
+		}
+
+		shard.numUnindexed.fetch_sub(ids.size(), std::memory_order_release);
+	}
+}
+
+//! Classification bits a type of \p kind with inner \p types gets on top of those of its base
+std::uint32_t kindFlags(TypeKind kind, Span<const TypeHandle> types) noexcept{
+	auto allValues = [&types]{
+		return std::all_of(begin(types), end(types), [](TypeHandle t){ return t->flags & TypeFlags::value; });
+	};
+
+	switch(kind){
+		case TypeKind::sizedNumber:
+		case TypeKind::string:
+			return TypeFlags::value;
+
+		case TypeKind::function: return TypeFlags::compound | TypeFlags::value;
+		case TypeKind::tree: return TypeFlags::compound | TypeFlags::tree;
+		case TypeKind::list: return TypeFlags::compound | TypeFlags::list;
+		case TypeKind::array: return TypeFlags::compound | TypeFlags::array;
+
+		case TypeKind::sum:
+		case TypeKind::product:
+		case TypeKind::dynamicArray:
+		case TypeKind::staticArray:
+			return TypeFlags::compound | (allValues() ? std::uint32_t(TypeFlags::value) : 0u);
+
+		default: return 0;
+	}
+}
+
+//! Bytes of the pooled string \p str, including its length prefix and terminator
+std::size_t internedBytes(InternedString str) noexcept{
+	return str.empty() ? 0 : sizeof(std::uint32_t) + str.size() + 1;
+}
+
+//! Add a newly created type to \p memory, holding the lock guarding it
+void accountNewType(TypeMemoryCounters &memory, TypeHandle type) noexcept{
+	auto &&counters = memory.kinds[static_cast<std::size_t>(type->kind)];
+	auto innerTypeBytes = sizeof(TypeHandle) * type->ancestors.size() + (sizeof(TypeHandle) + sizeof(TypeId)) * type->types.size();
+
+	TypeMemoryCounters::add(counters.numTypes, 1);
+	TypeMemoryCounters::add(counters.innerTypeBytes, innerTypeBytes);
+	TypeMemoryCounters::add(counters.nameBytes, internedBytes(type->str) + internedBytes(type->mangled));
+}
+
+/**
+ * \brief Create a type with the next free id in memory from \p arena
+ *
+ * A null \p base creates a type refined from itself.
+ **/
+Type *createType(
+	TypeData &data, TypeArena &arena, TypeHandle base,
+	TypeKind kind, Span<const TypeHandle> types = {}, std::uint64_t param = 0,
+	std::string_view str = {}, std::string_view mangled = {},
+	std::uint32_t familyFlags = 0
+){
+	auto type = arena.create<Type>();
+	type->base = base ? base : type;
+	type->id = data.shards ? data.shards->nextId++ : static_cast<TypeId>(data.storage.size());
+
+	if(base){
+		auto &&baseAncestors = base->ancestors;
+		auto ancestors = static_cast<TypeHandle*>(arena.allocate(sizeof(TypeHandle) * (baseAncestors.size() + 1), alignof(TypeHandle)));
+
+		std::copy(begin(baseAncestors), end(baseAncestors), ancestors);
+		ancestors[baseAncestors.size()] = base;
+
+		type->ancestors = {ancestors, baseAncestors.size() + 1};
+	}
+
+	// only family bits are inherited
+	auto baseFlags = base ? base->flags & ~(TypeFlags::compound | TypeFlags::value) : 0;
+
+	type->kind = kind;
+	type->flags = baseFlags | familyFlags | kindFlags(kind, types);
+	type->param = param;
+	type->types = types;
+	type->str = internString(data, str);
+	type->mangled = internString(data, mangled);
+
+	data.storage.store(type->id, type);
+	data.table.store(type, arena);
+
+	// compound types are named (and indexed) once they are interned
+	if(!isCompoundType(type))
+		indexNewType(data, type);
+
+	return type;
+}
+
+TypeHandle createEncodedStringType(TypeData &data, StringEncoding encoding){
+	std::string_view str, mangled;
 
 	switch(encoding){
-		case StringEncoding::ascii: type->str = "AsciiString"; type->mangled = "sa8"; break;
-		case StringEncoding::utf8:  type->str = "Utf8String"; type->mangled = "su8"; break;
+		case StringEncoding::ascii: str = "AsciiString"; mangled = "sa8"; break;
+		case StringEncoding::utf8:  str = "Utf8String"; mangled = "su8"; break;
 		default: return nullptr;
 	}
 
-	return data.storage.emplace_back(std::move(type)).get();
+	return createType(data, data.arena, data.stringType, TypeKind::string, {}, static_cast<std::uint64_t>(encoding), str, mangled);
 }
 
 TypeHandle createSizedNumberType(
 	TypeData &data, TypeHandle base,
-	const std::string &name, const std::string &mangledName,
+	std::string_view name, std::string_view mangledName,
 	std::uint32_t numBits
-) noexcept
+)
 {
 	if(numBits == 0) return base;
 
 	auto bitsStr = std::to_string(numBits);
-	auto type = std::make_unique<Type>();
+	auto str = std::string(name) + bitsStr;
+	auto mangled = std::string(mangledName) + bitsStr;
 
-	type->base = base;
-	type->str = name + bitsStr;
-	type->mangled = mangledName + bitsStr;
-
-	return data.storage.emplace_back(std::move(type)).get();
+	return createType(data, data.arena, base, TypeKind::sizedNumber, {}, numBits, str, mangled);
 }
 
 TypeHandle createFunctionType(
-	TypeData &data,
+	TypeData &data, TypeArena &arena,
 	const std::vector<TypeHandle> &params, TypeHandle ret
-) noexcept
+)
 {
-	auto type = std::make_unique<Type>();
-
-	type->base = data.functionType;
-	type->str = params[0]->str;
-	type->mangled = "f" + std::to_string(params.size()) + ret->mangled + params[0]->mangled;
-
-	for(std::size_t i = 1; i < params.size(); i++){
-		type->str += " -> " + params[i]->str;
-		type->mangled += params[i]->mangled;
-	}
-	
-	type->str += " -> " + ret->str;
-
-	type->types.reserve(params.size() + 1);
-	type->types.insert(begin(type->types), begin(params), end(params));
-	type->types.emplace_back(ret);
-
-	return data.storage.emplace_back(std::move(type)).get();
+	auto types = createInnerTypes(arena, params.data(), params.size(), ret);
+	return createType(data, arena, data.functionType, TypeKind::function, types);
 }
 
 template<typename Container, typename Key>
 TypeHandle findInnerType(const TypeData &data, TypeHandle base, const Container &cont, std::optional<Key> key) noexcept{
-	if(key){
-		auto res = cont.find(*key);
-		if(res != end(cont))
-			return res->second;
-
-		return nullptr;
-	}
-	else
-		return base;
+	return key ? cont.find(*key) : base;
 }
 
 template<typename Container>
@@ -84,8 +313,31 @@ TypeHandle getInnerType(
 	Container &&container, std::optional<Key> key,
 	Create &&create
 ){
-	auto res = findInnerType(data, base, container, key);
-	return res ? res : create(data, *key);
+	if(auto res = findInnerType(data, base, container, key)){
+		ILANG_TYPES_COUNT(countGet(data, res->kind, &TypeCounters::Kind::hits));
+		return res;
+	}
+
+	auto lock = writeLock(data, &TypeShards::mapsMutex);
+
+	// another thread may have created the type while no lock was held, it is found all the same
+	if(auto res = findInnerType(data, base, container, key)){
+		ILANG_TYPES_COUNT(countGet(data, res->kind, &TypeCounters::Kind::hits));
+		return res;
+	}
+
+	auto type = create(data, *key);
+	if(type){
+		container.emplace(*key, type);
+		accountNewType(*data.memory, type);
+
+		ILANG_TYPES_COUNT(
+			countGet(data, type->kind, &TypeCounters::Kind::misses),
+			countGet(data, type->kind, &TypeCounters::Kind::creations)
+		);
+	}
+
+	return type;
 }
 
 template<typename Container, typename Create>
@@ -101,64 +353,281 @@ TypeHandle getInnerNumberType(
 	);
 }
 
+TypeHandle findInternedType(const TypeData &data, const TypeKey &key){
+	auto hash = TypeInterner::hash(key);
+	if(!data.shards)
+		return data.internedTypes.find(data, key, hash);
+
+	return data.shards->shardFor(hash).interner.find(data, key, hash);
+}
+
+//! Render and index the names of a newly interned type, unless they are rendered on first access
+void nameInternedType(const TypeData &data, TypeHandle type){
+	if(data.lazyNames)
+		return;
+
+	getTypeName(data, type);
+	getMangledName(data, type);
+	indexNewType(data, type);
+}
+
+/**
+ * \brief Find the type with structure \p key, or create and intern it
+ *
+ * \p getBase gets (and may intern) the base of the new type; it is only called on a miss and,
+ * when \p data is shared between threads, without holding any lock.
+ * \p create is called with the arena for the type and its base.
+ **/
+template<typename GetBase, typename Create>
+TypeHandle getInternedType(TypeData &data, const TypeKey &key, GetBase &&getBase, Create &&create){
+	auto hash = TypeInterner::hash(key);
+
+	if(!data.shards){
+		if(auto res = data.internedTypes.find(data, key, hash)){
+			ILANG_TYPES_COUNT(countGet(data, key.kind, &TypeCounters::Kind::hits));
+			return res;
+		}
+
+		ILANG_TYPES_COUNT(
+			countGet(data, key.kind, &TypeCounters::Kind::misses),
+			countGet(data, key.kind, &TypeCounters::Kind::creations)
+		);
+
+		auto type = create(data.arena, getBase());
+		data.internedTypes.insert(type, hash);
+		accountNewType(*data.memory, type);
+		nameInternedType(data, type);
+		return type;
+	}
+
+	auto &&shard = data.shards->shardFor(hash);
+
+	if(auto res = shard.interner.find(data, key, hash)){
+		ILANG_TYPES_COUNT(countGet(data, key.kind, &TypeCounters::Kind::hits));
+		return res;
+	}
+
+	// the base may be interned in this same shard
+	auto base = getBase();
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	// another thread may have won the race while the lock was released
+	if(auto res = shard.interner.find(data, key, hash)){
+		ILANG_TYPES_COUNT(countGet(data, key.kind, &TypeCounters::Kind::hits));
+		return res;
+	}
+
+	ILANG_TYPES_COUNT(
+		countGet(data, key.kind, &TypeCounters::Kind::misses),
+		countGet(data, key.kind, &TypeCounters::Kind::creations)
+	);
+
+	// the type is named before it is published, so other threads never see it unnamed
+	auto type = create(shard.arena, base);
+	accountNewType(shard.memory, type);
+
+	if(data.lazyNames){
+		shard.unindexed.push_back(type->id);
+		shard.numUnindexed.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+		nameInternedType(data, type);
+
+	shard.interner.insert(type, hash);
+	return type;
+}
+
+void ilang::reserveTypes(TypeData &data, std::size_t n){
+	if(!data.shards)
+		data.internedTypes.reserve(data.internedTypes.size() + n);
+	else{
+		// hashes spread evenly over the shards, with some slack for the unlucky ones
+		auto numShards = data.shards->numShards;
+		auto perShard = n / numShards + n / (numShards * 4) + 16;
+
+		for(std::size_t i = 0; i < numShards; i++){
+			auto &&shard = data.shards->shards[i];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			shard.interner.reserve(shard.interner.size() + perShard);
+		}
+	}
+
+	if(!data.shards){
+		if(!data.lazyNames){
+			data.nameIndex.reserve(data.table.names, data.nameIndex.size() + n);
+			data.mangledIndex.reserve(data.table.mangledNames, data.mangledIndex.size() + n);
+		}
+	}
+	else{
+		auto numShards = data.shards->numShards;
+		auto perShard = n / numShards + n / (numShards * 4) + 16;
+
+		for(std::size_t i = 0; i < numShards; i++){
+			auto &&shard = data.shards->nameShards[i];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			shard.nameIndex.reserve(data.table.names, shard.nameIndex.size() + perShard);
+			shard.mangledIndex.reserve(data.table.mangledNames, shard.mangledIndex.size() + perShard);
+		}
+	}
+}
+
+InternedString renderJoinedName(const TypeData &data, Span<const TypeHandle> types, std::string_view sep){
+	std::string str;
+
+	for(std::size_t i = 0; i < types.size(); i++){
+		if(i > 0) str += sep;
+		str += getTypeName(data, types[i]);
+	}
+
+	return internString(data, str);
+}
+
+InternedString renderMangledList(const TypeData &data, std::string_view prefix, Span<const TypeHandle> types){
+	auto mangled = std::string(prefix) + std::to_string(types.size());
+
+	for(auto inner : types)
+		mangled += getMangledName(data, inner);
+
+	return internString(data, mangled);
+}
+
+InternedString renderTypeName(const TypeData &data, TypeHandle type){
+	switch(type->kind){
+		case TypeKind::tree: return internString(data, {"(Tree ", getTypeName(data, type->types[0]), ")"});
+		case TypeKind::list: return internString(data, {"(List ", getTypeName(data, type->types[0]), ")"});
+		case TypeKind::array: return internString(data, {"(Array ", getTypeName(data, type->types[0]), ")"});
+		case TypeKind::dynamicArray: return internString(data, {"(DynamicArray ", getTypeName(data, type->types[0]), ")"});
+		case TypeKind::staticArray: return internString(data, {"(StaticArray ", getTypeName(data, type->types[0]), " ", std::to_string(type->param), ")"});
+		case TypeKind::sum: return renderJoinedName(data, type->types, " | ");
+		case TypeKind::product: return renderJoinedName(data, type->types, " * ");
+		case TypeKind::function: return renderJoinedName(data, type->types, " -> ");
+		default: return type->str;
+	}
+}
+
+InternedString renderMangledName(const TypeData &data, TypeHandle type){
+	switch(type->kind){
+		case TypeKind::tree: return internString(data, {"ot0", getMangledName(data, type->types[0])});
+		case TypeKind::list: return internString(data, {"ol0", getMangledName(data, type->types[0])});
+		case TypeKind::array: return internString(data, {"oa0", getMangledName(data, type->types[0])});
+		case TypeKind::dynamicArray: return internString(data, {"ad", getMangledName(data, type->types[0])});
+		case TypeKind::staticArray: return internString(data, {"a", std::to_string(type->param), getMangledName(data, type->types[0])});
+		case TypeKind::sum: return renderMangledList(data, "u", type->types);
+		case TypeKind::product: return renderMangledList(data, "p", type->types);
+
+		case TypeKind::function:{
+			// arity, then the result, then the parameters
+			auto numParams = type->types.size() - 1;
+			auto mangled = "f" + std::to_string(numParams) + getMangledName(data, type->types[numParams]);
+
+			for(std::size_t i = 0; i < numParams; i++)
+				mangled += getMangledName(data, type->types[i]);
+
+			return internString(data, mangled);
+		}
+
+		default: return type->mangled;
+	}
+}
+
+/**
+ * \brief Store \p rendered as the \p name of \p type and its row of \p column, unless another thread already did
+ *
+ * \p isRendered is set once the name is stored, so it is read without a lock after an acquire load.
+ **/
+void storeRenderedName(
+	const TypeData &data, TypeHandle type, InternedString rendered,
+	InternedString &name, std::atomic<bool> &isRendered, SegmentedVector<InternedString> &column
+){
+	std::unique_lock<std::mutex> lock;
+	auto numRendered = &data.numRenderedNames;
+	auto memory = data.memory.get();
+
+	if(data.shards){
+		auto &&shard = data.shards->nameShardForId(type->id);
+		lock = std::unique_lock<std::mutex>(shard.mutex);
+		numRendered = &shard.numRenderedNames;
+		memory = &shard.memory;
+	}
+
+	if(isRendered.load(std::memory_order_relaxed))
+		return;
+
+	name = column[type->id] = rendered;
+	isRendered.store(true, std::memory_order_release);
+	++*numRendered;
+
+	TypeMemoryCounters::add(memory->kinds[static_cast<std::size_t>(type->kind)].nameBytes, internedBytes(rendered));
+}
+
+InternedString ilang::getTypeName(const TypeData &data, TypeHandle type){
+	ILANG_TYPES_RECORD_CALL(data);
+	ILANG_TYPES_RECORD(TypeCall::getTypeName, nullptr, type);
+
+	if(isCompoundType(type) && !type->strRendered.load(std::memory_order_acquire))
+		storeRenderedName(data, type, renderTypeName(data, type), type->str, type->strRendered, data.table.names);
+
+	return type->str;
+}
+
+InternedString ilang::getMangledName(const TypeData &data, TypeHandle type){
+	ILANG_TYPES_RECORD_CALL(data);
+	ILANG_TYPES_RECORD(TypeCall::getMangledName, nullptr, type);
+
+	if(isCompoundType(type) && !type->mangledRendered.load(std::memory_order_acquire))
+		storeRenderedName(data, type, renderMangledName(data, type), type->mangled, type->mangledRendered, data.table.mangledNames);
+
+	return type->mangled;
+}
+
+
 bool impl_isInfinityType(TypeHandle type) noexcept{
-	return type->mangled == "??";
+	return type->kind == TypeKind::infinity;
 }
 
 bool ilang::hasBaseType(TypeHandle type, TypeHandle baseType) noexcept{
+	ILANG_TYPES_COUNT(baseTypeCounters.checks.fetch_add(1, std::memory_order_relaxed));
+
 	if(impl_isInfinityType(baseType))
 		return true;
+
+	ILANG_TYPES_COUNT(baseTypeCounters.steps.fetch_add(1, std::memory_order_relaxed));
 	
-	while(1){
-		if(type->base == baseType)
-			return true;
-		else if(impl_isInfinityType(type->base))
-			return false;
-		else
-			type = type->base;
-	}
+	// baseType is a base of type if, and only if, it is type's ancestor at baseType's depth
+	auto depth = baseType->ancestors.size();
+	return depth < type->ancestors.size() && type->ancestors[depth] == baseType;
 }
 
-bool ilang::isRootType(TypeHandle type) noexcept{ return impl_isInfinityType(type->base) && !impl_isInfinityType(type); }
+bool ilang::hasBaseType(const TypeData &data, TypeId type, TypeId baseType) noexcept{
+	ILANG_TYPES_RECORD_CALL(data);
+	ILANG_TYPES_COUNT(baseTypeCounters.checks.fetch_add(1, std::memory_order_relaxed));
 
-bool ilang::isRefinedType(TypeHandle type) noexcept{
-	if(isRootType(type->base))
-		return true;
-	else if(impl_isInfinityType(type->base))
-		return false;
-	
-	return isRefinedType(type->base);
-}
+	// Infinity has id 0 and is the only type refined from itself
+	auto res = baseType == 0;
 
-bool ilang::isCompoundType(TypeHandle type) noexcept;
+	if(!res){
+		ILANG_TYPES_COUNT(baseTypeCounters.steps.fetch_add(1, std::memory_order_relaxed));
 
-bool ilang::isListType(TypeHandle type, const TypeData &data) noexcept{
-	if(type->types.size() != 1)
-		return false;
-	
-	auto listBase = findListType(data, type->types[0]);
-	if(!listBase)
-		return false;
-	
-	return hasBaseType(type, listBase);
-}
+		auto depth = data.table.depths[baseType];
+		res = depth < data.table.depths[type] && data.storage[type]->ancestors[depth] == data.storage[baseType];
+	}
 
-bool ilang::isArrayType(TypeHandle type, const TypeData& data) noexcept{
-	if(type->types.size() != 1)
-		return false;
-	
-	auto arrayBase = findArrayType(data, type->types[0]);
-	if(!arrayBase)
-		return false;
-	
-	return hasBaseType(type, arrayBase);
+	ILANG_TYPES_RECORD(TypeCall::hasBaseType, res, data.storage[type], data.storage[baseType]);
+	return res;
 }
 
+bool ilang::isRootType(TypeHandle type) noexcept{ return type->ancestors.size() == 1; }
 
-#define REFINED_TYPE_CHECK(type, typeLower)\
-bool ilang::is##type##Type(TypeHandle type, const TypeData &data) noexcept{\
-	auto baseType = data.typeLower##Type;\
-	return type == baseType || hasBaseType(type, baseType);\
+bool ilang::isRefinedType(TypeHandle type) noexcept{ return type->ancestors.size() >= 2; }
+
+bool ilang::isValueType(TypeHandle type) noexcept{ return type->flags & TypeFlags::value; }
+
+bool ilang::isCompoundType(TypeHandle type) noexcept{ return type->flags & TypeFlags::compound; }
+
+#define REFINED_TYPE_CHECK(type, flag)\
+bool ilang::is##type##Type(TypeHandle type, const TypeData&) noexcept{\
+	return type->flags & TypeFlags::flag;\
 }
 
 REFINED_TYPE_CHECK(Unit, unit)
@@ -166,6 +635,10 @@ REFINED_TYPE_CHECK(Type, type)
 REFINED_TYPE_CHECK(Partial, partial)
 REFINED_TYPE_CHECK(Function, function)
 REFINED_TYPE_CHECK(Number, number)
+REFINED_TYPE_CHECK(String, string)
+REFINED_TYPE_CHECK(Tree, tree)
+REFINED_TYPE_CHECK(List, list)
+REFINED_TYPE_CHECK(Array, array)
 REFINED_TYPE_CHECK(Complex, complex)
 REFINED_TYPE_CHECK(Imaginary, imaginary)
 REFINED_TYPE_CHECK(Real, real)
@@ -173,22 +646,32 @@ REFINED_TYPE_CHECK(Rational, rational)
 REFINED_TYPE_CHECK(Integer, integer)
 REFINED_TYPE_CHECK(Natural, natural)
 REFINED_TYPE_CHECK(Boolean, boolean)
-REFINED_TYPE_CHECK(String, string)
 
 #define NUMBER_VALUE_TYPE(T, t, mangledSig)\
 TypeHandle create##T##Type(TypeData &data, std::uint32_t numBits){\
 	return createSizedNumberType(data, data.t##Type, #T, mangledSig, numBits);\
 }\
 TypeHandle ilang::find##T##Type(const TypeData &data, std::uint32_t numBits) noexcept{\
-	return findInnerNumberType(data, data.t##Type, data.sized##T##Types, numBits);\
+	ILANG_TYPES_TRACE("find" #T "Type");\
+	ILANG_TYPES_RECORD_CALL(data);\
+	auto res = findInnerNumberType(data, data.t##Type, data.sized##T##Types, numBits);\
+	ILANG_TYPES_RECORD(TypeCall::find##T##Type, res, numBits);\
+	return res;\
 }\
 TypeHandle ilang::get##T##Type(TypeData &data, std::uint32_t numBits){\
-	return getInnerNumberType(data, data.t##Type, data.sized##T##Types, numBits, create##T##Type);\
+	ILANG_TYPES_TRACE("get" #T "Type");\
+	ILANG_TYPES_RECORD_CALL(data);\
+	auto res = getInnerNumberType(data, data.t##Type, data.sized##T##Types, numBits, create##T##Type);\
+	ILANG_TYPES_RECORD(TypeCall::get##T##Type, res, numBits);\
+	return res;\
 }
 
 #define ROOT_TYPE(T, t)\
 TypeHandle ilang::find##T##Type(const TypeData &data) noexcept{ return data.t##Type; }\
-TypeHandle ilang::get##T##Type(TypeData &data){ return data.t##Type; }
+TypeHandle ilang::get##T##Type(TypeData &data){\
+	ILANG_TYPES_COUNT(countGet(data, data.t##Type->kind, &TypeCounters::Kind::hits));\
+	return data.t##Type;\
+}
 
 ROOT_TYPE(Infinity, infinity)
 ROOT_TYPE(Type, type)
@@ -203,340 +686,346 @@ NUMBER_VALUE_TYPE(Real, real, "r")
 NUMBER_VALUE_TYPE(Imaginary, imaginary, "i")
 NUMBER_VALUE_TYPE(Complex, complex, "c")
 
-template<typename Comp>
-auto getSortedTypes(const TypeData &data, Comp &&comp = std::less<void>{}){
-	std::vector<TypeHandle> types;
-	types.reserve(data.storage.size());
-	
-	std::transform(
-		begin(data.storage), end(data.storage),
-		std::back_inserter(types),
-		[](auto &&ptr){ return ptr.get(); }
-	);
-	
-	std::sort(begin(types), end(types), std::forward<Comp>(comp));
-	return types;
+/**
+ * \brief Find the type named \p name in \p index of \p data, or in its shard of \p shardIndex when shared between threads
+ *
+ * Names are indexed as types are created unless they are rendered lazily,
+ * in that case \p indexNames (or the queue of each shard) indexes the remaining types first.
+ **/
+TypeId findIndexedName(
+	const TypeData &data, NameIndex TypeData::*index, NameIndex NameShard::*shardIndex,
+	const SegmentedVector<InternedString> &names, std::string_view name,
+	void(*indexNames)(const TypeData&)
+){
+	if(!data.shards){
+		if(data.lazyNames)
+			indexNames(data);
+
+		return (data.*index).find(names, name);
+	}
+
+	if(data.lazyNames)
+		indexQueuedTypes(data);
+
+	auto hash = NameIndex::hash(name);
+	return (data.shards->nameShardFor(hash).*shardIndex).find(names, name, hash);
 }
 
 TypeHandle ilang::findTypeByString(const TypeData &data, std::string_view str){
-	auto strS = std::string(str);
-	
-	auto aliased = data.typeAliases.find(strS);
-	if(aliased != end(data.typeAliases))
-		return aliased->second;
-	
-	auto types = getSortedTypes(data, [](auto lhs, auto rhs){ return lhs->str < rhs->str; });
-	auto res = std::lower_bound(begin(types), end(types), str, [](TypeHandle lhs, std::string_view rhs){ return lhs->str < std::string(rhs); });
-	
-	if((res != end(types)) && (str < (*res)->str))
-		res = end(types);
-	
-	if(res != end(types))
-		return *res;
-	
-	return nullptr;
+	ILANG_TYPES_TRACE("findTypeByString");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = countLookup(data, &TypeCounters::stringLookups, [&]() -> TypeHandle{
+		auto aliased = data.typeAliases.find(str);
+		if(aliased != end(data.typeAliases))
+			return aliased->second;
+		
+		auto id = findIndexedName(data, &TypeData::nameIndex, &NameShard::nameIndex, data.table.names, str, indexTypeNames);
+		return id != invalidTypeId ? data.storage[id] : nullptr;
+	});
+	ILANG_TYPES_RECORD(TypeCall::findTypeByString, res, str);
+	return res;
 }
 
 TypeHandle ilang::findTypeByMangled(const TypeData &data, std::string_view mangled){
-	auto types = getSortedTypes(data, [](auto lhs, auto rhs){ return lhs->mangled < rhs->mangled; });
-	auto res = std::lower_bound(begin(types), end(types), mangled, [](TypeHandle lhs, std::string_view rhs){ return lhs->mangled < std::string(rhs); });
-	
-	if((res != end(types)) && (mangled < (*res)->mangled))
-		res = end(types);
-	
-	if(res != end(types))
-		return *res;
-	
-	return nullptr;
+	ILANG_TYPES_TRACE("findTypeByMangled");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = countLookup(data, &TypeCounters::mangledLookups, [&]() -> TypeHandle{
+		auto id = findIndexedName(data, &TypeData::mangledIndex, &NameShard::mangledIndex, data.table.mangledNames, mangled, indexMangledNames);
+		return id != invalidTypeId ? data.storage[id] : nullptr;
+	});
+	ILANG_TYPES_RECORD(TypeCall::findTypeByMangled, res, mangled);
+	return res;
 }
 
 TypeHandle ilang::findCommonType(TypeHandle type0, TypeHandle type1) noexcept{
-	if(type0 == type1 || hasBaseType(type1, type0)) return type0;
-	else if(hasBaseType(type0, type1)) return type1;
-	else return findCommonType(type0->base, type1->base);
+	ILANG_TYPES_TRACE("findCommonType");
+	if(type0 == type1)
+		return type0;
+	
+	// paths from Infinity to each type share a prefix ending in the common type,
+	// so binary search for the deepest depth both paths agree on
+	auto depth0 = type0->ancestors.size(), depth1 = type1->ancestors.size();
+	auto at0 = [&](std::size_t d){ return d < depth0 ? type0->ancestors[d] : type0; };
+	auto at1 = [&](std::size_t d){ return d < depth1 ? type1->ancestors[d] : type1; };
+	
+	std::size_t lo = 0, hi = std::min(depth0, depth1);
+	
+	while(lo < hi){
+		auto mid = lo + (hi - lo + 1) / 2;
+		if(at0(mid) == at1(mid))
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	
+	return at0(lo);
+}
+
+TypeId ilang::findCommonType(const TypeData &data, TypeId type0, TypeId type1) noexcept{
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = findCommonType(data.storage[type0], data.storage[type1]);
+	ILANG_TYPES_RECORD(TypeCall::findCommonType, res, data.storage[type0], data.storage[type1]);
+	return res->id;
 }
 
 TypeHandle ilang::findPartialType(const TypeData &data, std::optional<std::uint32_t> id) noexcept{
-	if(!id)
-		return data.partialType;
+	ILANG_TYPES_TRACE("findPartialType");
+	ILANG_TYPES_RECORD_CALL(data);
 
-	auto num = *id;
+	TypeHandle res = data.partialType;
 
-	if(data.partialTypes.size() >= num)
-		return nullptr;
-	else
-		return data.partialTypes[num];
+	if(id){
+		auto num = *id;
+		res = num < data.partialTypes.size() ? data.partialTypes[num] : nullptr;
+	}
+
+	ILANG_TYPES_RECORD(TypeCall::findPartialType, res, id);
+	return res;
 }
 
 TypeHandle ilang::findStringType(const TypeData &data, std::optional<StringEncoding> encoding) noexcept{
-	return findInnerType(data, data.stringType, data.encodedStringTypes, encoding);
+	ILANG_TYPES_TRACE("findStringType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = findInnerType(data, data.stringType, data.encodedStringTypes, encoding);
+	ILANG_TYPES_RECORD(TypeCall::findStringType, res, encoding);
+	return res;
 }
 
 TypeHandle ilang::findTreeType(const TypeData &data, TypeHandle t) noexcept{
-	return findInnerType(data, nullptr, data.treeTypes, std::make_optional(t));
+	ILANG_TYPES_TRACE("findTreeType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = findInternedType(data, makeInnerKey(TypeKind::tree, t));
+	ILANG_TYPES_RECORD(TypeCall::findTreeType, res, t);
+	return res;
 }
 
 TypeHandle ilang::findListType(const TypeData &data, TypeHandle t) noexcept{
-	return findInnerType(data, nullptr, data.listTypes, std::make_optional(t));
+	ILANG_TYPES_TRACE("findListType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = findInternedType(data, makeInnerKey(TypeKind::list, t));
+	ILANG_TYPES_RECORD(TypeCall::findListType, res, t);
+	return res;
 }
 
 TypeHandle ilang::findArrayType(const TypeData &data, TypeHandle t) noexcept{
-	return findInnerType(data, nullptr, data.arrayTypes, std::make_optional(t));
+	ILANG_TYPES_TRACE("findArrayType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = findInternedType(data, makeInnerKey(TypeKind::array, t));
+	ILANG_TYPES_RECORD(TypeCall::findArrayType, res, t);
+	return res;
 }
 
 TypeHandle ilang::findDynamicArrayType(const TypeData &data, TypeHandle t) noexcept{
-	return findInnerType(data, nullptr, data.listTypes, std::make_optional(t));
+	ILANG_TYPES_TRACE("findDynamicArrayType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = findInternedType(data, makeInnerKey(TypeKind::dynamicArray, t));
+	ILANG_TYPES_RECORD(TypeCall::findDynamicArrayType, res, t);
+	return res;
 }
 
 TypeHandle ilang::findStaticArrayType(const TypeData &data, TypeHandle t, std::size_t n) noexcept{
-	auto res = data.staticArrayTypes.find(t);
-	if(res != end(data.staticArrayTypes))
-		return findInnerType(data, nullptr, res->second, std::make_optional(n));
-	
-	return nullptr;
+	ILANG_TYPES_TRACE("findStaticArrayType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = findInternedType(data, makeInnerKey(TypeKind::staticArray, t, n));
+	ILANG_TYPES_RECORD(TypeCall::findStaticArrayType, res, t, n);
+	return res;
 }
 
 TypeHandle findSumTypeInner(const TypeData &data, const std::vector<TypeHandle> &uniqueSortedInnerTypes) noexcept{
-	return findInnerType(data, nullptr, data.sumTypes, std::make_optional(std::ref(uniqueSortedInnerTypes)));	
+	return findInternedType(data, makeListKey(TypeKind::sum, uniqueSortedInnerTypes));
 }
 
 TypeHandle ilang::findSumType(const TypeData &data, std::vector<TypeHandle> innerTypes) noexcept{
-	std::sort(begin(innerTypes), end(innerTypes));
-	innerTypes.erase(std::unique(begin(innerTypes), end(innerTypes)), end(innerTypes));
-	return findSumTypeInner(data, innerTypes);
+	ILANG_TYPES_TRACE("findSumType");
+	ILANG_TYPES_RECORD_CALL(data);
+	sortInnerTypes(innerTypes);
+	auto res = findSumTypeInner(data, innerTypes);
+	ILANG_TYPES_RECORD(TypeCall::findSumType, res, innerTypes);
+	return res;
 }
 
 TypeHandle ilang::findProductType(const TypeData &data, const std::vector<TypeHandle> &innerTypes) noexcept{
-	return findInnerType(data, nullptr, data.productTypes, std::make_optional(std::ref(innerTypes)));
+	ILANG_TYPES_TRACE("findProductType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = findInternedType(data, makeListKey(TypeKind::product, innerTypes));
+	ILANG_TYPES_RECORD(TypeCall::findProductType, res, innerTypes);
+	return res;
 }
 
 TypeHandle ilang::findFunctionType(const TypeData &data, const std::vector<TypeHandle> &params, TypeHandle result) noexcept{
-	auto paramsRes = data.functionTypes.find(params);
-	if(paramsRes != end(data.functionTypes)){
-		auto resultRes = paramsRes->second.find(result);
-		if(resultRes != end(paramsRes->second))
-			return resultRes->second;
-	}
-
-	return nullptr;
+	ILANG_TYPES_TRACE("findFunctionType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = findInternedType(data, makeFunctionKey(params, result));
+	ILANG_TYPES_RECORD(TypeCall::findFunctionType, res, params, result);
+	return res;
 }
 
 TypeHandle ilang::findFunctionType(const TypeData &data) noexcept{ return data.functionType; }
 
+TypeHandle ilang::findCompoundType(const TypeData &data, const TypeKey &key) noexcept{
+	ILANG_TYPES_TRACE("findCompoundType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = findInternedType(data, key);
+	ILANG_TYPES_RECORD(TypeCall::findCompoundType, res, key);
+	return res;
+}
+
 TypeHandle ilang::getStringType(TypeData &data, std::optional<StringEncoding> encoding){
-	return getInnerType(data, data.stringType, data.encodedStringTypes, encoding, createEncodedStringType);
+	ILANG_TYPES_TRACE("getStringType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = getInnerType(data, data.stringType, data.encodedStringTypes, encoding, createEncodedStringType);
+	ILANG_TYPES_RECORD(TypeCall::getStringType, res, encoding);
+	return res;
 }
 
 TypeHandle ilang::getTreeType(TypeData &data, TypeHandle t){
-	if(auto res = findTreeType(data, t))
-		return res;
-	
-	auto ptr = data.storage.emplace_back(std::make_unique<Type>()).get();
-	
-	ptr->base = data.infinityType;
-	ptr->str = "(Tree " + t->str + ")";
-	ptr->mangled = "ot0" + t->mangled;
-	ptr->types = {t};
-	
-	data.treeTypes[t] = ptr;
-	
-	return ptr;
+	ILANG_TYPES_TRACE("getTreeType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = getInternedType(data, makeInnerKey(TypeKind::tree, t), [&]{ return data.infinityType; }, [&](TypeArena &arena, TypeHandle base){
+		return createType(data, arena, base, TypeKind::tree, createInnerTypes(arena, &t, 1));
+	});
+	ILANG_TYPES_RECORD(TypeCall::getTreeType, res, t);
+	return res;
 }
 
 TypeHandle ilang::getListType(TypeData &data, TypeHandle t){
-	if(auto res = findListType(data, t))
-		return res;
-	
-	auto newType = std::make_unique<Type>();
-	
-	newType->base = getTreeType(data, t);
-	newType->str = "(List " + t->str + ")";
-	newType->mangled = "ol0" + t->mangled;
-	newType->types = {t};
-	
-	auto ptr = data.storage.emplace_back(std::move(newType)).get();
-	
-	data.listTypes[t] = ptr;
-	
-	return ptr;
+	ILANG_TYPES_TRACE("getListType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = getInternedType(data, makeInnerKey(TypeKind::list, t), [&]{ return getTreeType(data, t); }, [&](TypeArena &arena, TypeHandle base){
+		return createType(data, arena, base, TypeKind::list, createInnerTypes(arena, &t, 1));
+	});
+	ILANG_TYPES_RECORD(TypeCall::getListType, res, t);
+	return res;
 }
 
 TypeHandle ilang::getArrayType(TypeData &data, TypeHandle t){
-	if(auto res = findArrayType(data, t))
-		return res;
-	
-	auto newType = std::make_unique<Type>();
-	
-	newType->base = getListType(data, t);
-	newType->str = "(Array " + t->str + ")";
-	newType->mangled = "oa0" + t->mangled;
-	newType->types = {t};
-	
-	auto ptr = data.storage.emplace_back(std::move(newType)).get();
-	
-	data.arrayTypes[t] = ptr;
-	
-	return ptr;
+	ILANG_TYPES_TRACE("getArrayType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = getInternedType(data, makeInnerKey(TypeKind::array, t), [&]{ return getListType(data, t); }, [&](TypeArena &arena, TypeHandle base){
+		return createType(data, arena, base, TypeKind::array, createInnerTypes(arena, &t, 1));
+	});
+	ILANG_TYPES_RECORD(TypeCall::getArrayType, res, t);
+	return res;
 }
 
 TypeHandle ilang::getDynamicArrayType(TypeData &data, TypeHandle t){
-	if(auto res = findDynamicArrayType(data, t))
-		return res;
-	
-	auto newType = std::make_unique<Type>();
-	
-	newType->base = getArrayType(data, t);
-	newType->str = "(DynamicArray " + t->str + ")";
-	newType->mangled = "a0" + t->mangled;
-	newType->types = {t};
-	
-	auto ptr = data.storage.emplace_back(std::move(newType)).get();
-	
-	data.dynamicArrayTypes[t] = ptr;
-	
-	return ptr;
+	ILANG_TYPES_TRACE("getDynamicArrayType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = getInternedType(data, makeInnerKey(TypeKind::dynamicArray, t), [&]{ return getArrayType(data, t); }, [&](TypeArena &arena, TypeHandle base){
+		return createType(data, arena, base, TypeKind::dynamicArray, createInnerTypes(arena, &t, 1));
+	});
+	ILANG_TYPES_RECORD(TypeCall::getDynamicArrayType, res, t);
+	return res;
 }
 
 TypeHandle ilang::getStaticArrayType(TypeData &data, TypeHandle t, std::size_t n){
-	if(auto res = findStaticArrayType(data, t, n))
-		return res;
-	
-	auto newType = std::make_unique<Type>();
-	
-	auto nStr = std::to_string(n);
-	
-	newType->base = getArrayType(data, t);
-	newType->str = "(StaticArray " + t->str + " " + nStr + ")";
-	newType->mangled = "a" + nStr + t->mangled;
-	newType->types = {t};
-	
-	auto ptr = data.storage.emplace_back(std::move(newType)).get();
-	
-	data.staticArrayTypes[t][n] = ptr;
-	
-	return ptr;
+	ILANG_TYPES_TRACE("getStaticArrayType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = getInternedType(data, makeInnerKey(TypeKind::staticArray, t, n), [&]{ return getArrayType(data, t); }, [&](TypeArena &arena, TypeHandle base){
+		return createType(data, arena, base, TypeKind::staticArray, createInnerTypes(arena, &t, 1), n);
+	});
+	ILANG_TYPES_RECORD(TypeCall::getStaticArrayType, res, t, n);
+	return res;
 }
 
 TypeHandle ilang::getPartialType(TypeData &data){
-	auto type = std::make_unique<Type>();
-	auto id = std::to_string(data.partialTypes.size());
-	type->base = data.partialType;
-	type->str = "Partial" + id;
-	type->mangled = "_" + id;
-	auto &&typePtr = data.storage.emplace_back(std::move(type));
-	return typePtr.get();
+	ILANG_TYPES_TRACE("getPartialType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto lock = writeLock(data, &TypeShards::mapsMutex);
+
+	auto index = data.partialTypes.size();
+	auto id = std::to_string(index);
+	auto type = createType(data, data.arena, data.partialType, TypeKind::partial, {}, index, "Partial" + id, "_" + id);
+	data.partialTypes.emplace_back(type);
+	accountNewType(*data.memory, type);
+
+	// every partial type is new
+	ILANG_TYPES_COUNT(
+		countGet(data, TypeKind::partial, &TypeCounters::Kind::misses),
+		countGet(data, TypeKind::partial, &TypeCounters::Kind::creations)
+	);
+	ILANG_TYPES_RECORD(TypeCall::getPartialType, type);
+	return type;
 }
 
 TypeHandle ilang::getSumType(TypeData &data, std::vector<TypeHandle> innerTypes){
-	std::sort(begin(innerTypes), end(innerTypes));
-	innerTypes.erase(std::unique(begin(innerTypes), end(innerTypes)), end(innerTypes));
-	
-	if(auto res = findSumTypeInner(data, innerTypes))
-		return res;
-	
-	auto &&newType = data.storage.emplace_back(std::make_unique<Type>());
-	
-	newType->base = findInfinityType(data);
-	newType->types = std::move(innerTypes);
-	
-	newType->mangled = "u" + std::to_string(innerTypes.size());
-	newType->mangled += innerTypes[0]->mangled;
-	
-	newType->str = innerTypes[0]->str;
-	
-	for(std::size_t i = 1; i < innerTypes.size(); i++){
-		newType->mangled += innerTypes[i]->mangled;
-		newType->str += " | " + innerTypes[i]->str;
-	}
-	
-	auto[it, good] = data.sumTypes.try_emplace(newType->types, newType.get());
-	
-	if(!good){
-		// TODO: throw TypeError
-	}
-	
-	return newType.get();
+	ILANG_TYPES_TRACE("getSumType");
+	ILANG_TYPES_RECORD_CALL(data);
+	sortInnerTypes(innerTypes);
+	
+	auto res = getInternedType(data, makeListKey(TypeKind::sum, innerTypes), [&]{ return data.infinityType; }, [&](TypeArena &arena, TypeHandle base){
+		return createType(data, arena, base, TypeKind::sum, createInnerTypes(arena, innerTypes));
+	});
+	ILANG_TYPES_RECORD(TypeCall::getSumType, res, innerTypes);
+	return res;
 }
 
 TypeHandle ilang::getProductType(TypeData &data, std::vector<TypeHandle> innerTypes){
+	ILANG_TYPES_TRACE("getProductType");
+	ILANG_TYPES_RECORD_CALL(data);
 	if(innerTypes.size() < 2){
 		// TODO: throw TypeError
 		throw std::runtime_error("product type can not have less than 2 inner types");
 	}
 	
-	if(auto res = findProductType(data, innerTypes))
-		return res;
-	
-	auto &&newType = data.storage.emplace_back(std::make_unique<Type>());
-	
-	newType->base = findInfinityType(data);
-	
-	newType->mangled = "p" + std::to_string(innerTypes.size()) + innerTypes[0]->mangled;
-	newType->str = innerTypes[0]->str;
-	
-	for(std::size_t i = 1; i < innerTypes.size(); i++){
-		newType->mangled += innerTypes[i]->mangled;
-		newType->str += " * " + innerTypes[i]->str;
-	}
-
-	newType->types = std::move(innerTypes);
-	
-	auto[it, good] = data.productTypes.try_emplace(newType->types, newType.get());
-	
-	if(!good){
-		// TODO: throw TypeError
-	}
-	
-	return newType.get();
+	auto res = getInternedType(data, makeListKey(TypeKind::product, innerTypes), [&]{ return data.infinityType; }, [&](TypeArena &arena, TypeHandle base){
+		return createType(data, arena, base, TypeKind::product, createInnerTypes(arena, innerTypes));
+	});
+	ILANG_TYPES_RECORD(TypeCall::getProductType, res, innerTypes);
+	return res;
 }
 
 TypeHandle ilang::getFunctionType(TypeData &data, std::vector<TypeHandle> params, TypeHandle result){
-	auto &&retMap = data.functionTypes[params];
-
-	auto res = retMap.find(result);
-	if(res != end(retMap))
-		return res->second;
+	ILANG_TYPES_TRACE("getFunctionType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = getInternedType(data, makeFunctionKey(params, result), [&]{ return data.functionType; }, [&](TypeArena &arena, TypeHandle){
+		return createFunctionType(data, arena, params, result);
+	});
+	ILANG_TYPES_RECORD(TypeCall::getFunctionType, res, params, result);
+	return res;
+}
 
-	return retMap[result] = createFunctionType(data, params, result);
+std::size_t roundUpToPowerOfTwo(std::size_t n) noexcept{
+	std::size_t res = 1;
+	while(res < n) res *= 2;
+	return res;
 }
 
-TypeData::TypeData(){
+TypeData::TypeData(const TypeDataOptions &options)
+	: lazyNames(options.lazyNames)
+	, shards(options.concurrent ? std::make_unique<TypeShards>(roundUpToPowerOfTwo(options.numShards)) : nullptr)
+	, memory(std::make_unique<TypeMemoryCounters>())
+{
+	ILANG_TYPES_COUNT(counters = std::make_unique<TypeCounters>());
+
 	auto newInfinityType = [this](){
-		auto &&ptr = storage.emplace_back(std::make_unique<Type>());
-		ptr->base = ptr.get();
-		ptr->str = "Infinity";
-		ptr->mangled = "??";
-		return ptr.get();
+		return createType(*this, arena, nullptr, TypeKind::infinity, {}, 0, "Infinity", "??");
 	};
 
-	auto newType = [this](std::string str, std::string mangled, auto base){
-		auto &&ptr = storage.emplace_back(std::make_unique<Type>());
-		ptr->base = base;
-		ptr->str = std::move(str);
-		ptr->mangled = std::move(mangled);
-		return ptr.get();
+	auto newType = [this](std::string_view str, std::string_view mangled, auto base, std::uint32_t flags){
+		return createType(*this, arena, base, TypeKind::number, {}, 0, str, mangled, flags);
 	};
 
 	infinityType = newInfinityType();
 
-	auto newRootType = [&newType, this](auto str, auto mangled){
-		return newType(str, mangled, infinityType);
+	auto newRootType = [this](std::string_view str, std::string_view mangled, std::uint32_t flags){
+		return createType(*this, arena, infinityType, TypeKind::root, {}, 0, str, mangled, flags);
 	};
 	
-	partialType = newRootType("Partial", "_?");
-	typeType = newRootType("Type", "t?");
-	unitType = newRootType("Unit", "u0");
-	stringType = newRootType("String", "s?");
-	numberType = newRootType("Number", "w?");
-	functionType = newRootType("Function", "f?");
-
-	complexType = newType("Complex", "c?", numberType);
-	imaginaryType = newType("Imaginary", "i?", complexType);
-	realType = newType("Real", "r?", complexType);
-	rationalType = newType("Rational", "q?", realType);
-	integerType = newType("Integer", "z?", rationalType);
-	naturalType = newType("Natural", "n?", integerType);
-	booleanType = newType("Boolean", "b?", naturalType);
+	partialType = newRootType("Partial", "_?", TypeFlags::partial);
+	typeType = newRootType("Type", "t?", TypeFlags::type);
+	unitType = newRootType("Unit", "p0", TypeFlags::unit | TypeFlags::value);
+	stringType = newRootType("String", "s?", TypeFlags::string);
+	numberType = newRootType("Number", "w?", TypeFlags::number);
+	functionType = newRootType("Function", "f?", TypeFlags::function);
+
+	complexType = newType("Complex", "c?", numberType, TypeFlags::complex);
+	imaginaryType = newType("Imaginary", "i?", complexType, TypeFlags::imaginary);
+	realType = newType("Real", "r?", complexType, TypeFlags::real);
+	rationalType = newType("Rational", "q?", realType, TypeFlags::rational);
+	integerType = newType("Integer", "z?", rationalType, TypeFlags::integer);
+	naturalType = newType("Natural", "n?", integerType, TypeFlags::natural);
+	booleanType = newType("Boolean", "b?", naturalType, TypeFlags::boolean);
 	
 	typeAliases["Ratio"] = rationalType;
 	typeAliases["Int"] = integerType;
@@ -547,34 +1036,34 @@ TypeData::TypeData(){
 	auto real32Type = createSizedNumberType(*this, real64Type, "Real", "r", 32);
 	auto real16Type = createSizedNumberType(*this, real32Type, "Real", "r", 16);
 	
-	sizedRealTypes[64] = real64Type;
-	sizedRealTypes[32] = real32Type;
-	sizedRealTypes[16] = real16Type;
+	sizedRealTypes.emplace(64, real64Type);
+	sizedRealTypes.emplace(32, real32Type);
+	sizedRealTypes.emplace(16, real16Type);
 	
 	auto rational128Type = createSizedNumberType(*this, realType, "Rational", "q", 128);
 	auto rational64Type = createSizedNumberType(*this, rational128Type, "Rational", "q", 64);
 	auto rational32Type = createSizedNumberType(*this, rational64Type, "Rational", "q", 32);
 	auto rational16Type = createSizedNumberType(*this, rational32Type, "Rational", "q", 16);
 	
-	sizedRationalTypes[128] = rational128Type;
-	sizedRationalTypes[64] = rational64Type;
-	sizedRationalTypes[32] = rational32Type;
-	sizedRationalTypes[16] = rational16Type;
+	sizedRationalTypes.emplace(128, rational128Type);
+	sizedRationalTypes.emplace(64, rational64Type);
+	sizedRationalTypes.emplace(32, rational32Type);
+	sizedRationalTypes.emplace(16, rational16Type);
 	
 	typeAliases["Ratio128"] = rational128Type;
 	typeAliases["Ratio64"] = rational64Type;
 	typeAliases["Ratio32"] = rational32Type;
 	typeAliases["Ratio16"] = rational16Type;
 	
-	auto int64Type = createSizedNumberType(*this, integerType, "Integer", "i", 64);
-	auto int32Type = createSizedNumberType(*this, int64Type, "Integer", "i", 32);
-	auto int16Type = createSizedNumberType(*this, int32Type, "Integer", "i", 16);
-	auto int8Type = createSizedNumberType(*this, int16Type, "Integer", "i", 8);
+	auto int64Type = createSizedNumberType(*this, integerType, "Integer", "z", 64);
+	auto int32Type = createSizedNumberType(*this, int64Type, "Integer", "z", 32);
+	auto int16Type = createSizedNumberType(*this, int32Type, "Integer", "z", 16);
+	auto int8Type = createSizedNumberType(*this, int16Type, "Integer", "z", 8);
 	
-	sizedIntegerTypes[64] = int64Type;
-	sizedIntegerTypes[32] = int32Type;
-	sizedIntegerTypes[16] = int16Type;
-	sizedIntegerTypes[8]  = int8Type;
+	sizedIntegerTypes.emplace(64, int64Type);
+	sizedIntegerTypes.emplace(32, int32Type);
+	sizedIntegerTypes.emplace(16, int16Type);
+	sizedIntegerTypes.emplace(8, int8Type);
 	
 	typeAliases["Int64"] = int64Type;
 	typeAliases["Int32"] = int32Type;
@@ -586,13 +1075,19 @@ TypeData::TypeData(){
 	auto nat16Type = createSizedNumberType(*this, nat32Type, "Natural", "n", 16);
 	auto nat8Type = createSizedNumberType(*this, nat16Type, "Natural", "n", 8);
 	
-	sizedNaturalTypes[64] = nat64Type;
-	sizedNaturalTypes[32] = nat32Type;
-	sizedNaturalTypes[16] = nat16Type;
-	sizedNaturalTypes[8]  = nat8Type;
+	sizedNaturalTypes.emplace(64, nat64Type);
+	sizedNaturalTypes.emplace(32, nat32Type);
+	sizedNaturalTypes.emplace(16, nat16Type);
+	sizedNaturalTypes.emplace(8, nat8Type);
 	
 	typeAliases["Nat64"] = nat64Type;
 	typeAliases["Nat32"] = nat32Type;
 	typeAliases["Nat16"] = nat16Type;
 	typeAliases["Nat8"] = nat8Type;
+
+	// the prelude is created directly, not through the functions that account new types
+	for(auto type : storage)
+		accountNewType(*memory, type);
+
+	numPreludeTypes = storage.size();
 }
@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include "ilang/TypeBatch.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Blocks threads until all of them arrived, reusable
+	struct Barrier{
+		explicit Barrier(std::size_t n): numThreads(n){}
+
+		void wait(){
+			std::unique_lock<std::mutex> lock(mutex);
+
+			auto gen = generation;
+			if(++numArrived == numThreads){
+				numArrived = 0;
+				++generation;
+				cond.notify_all();
+			}
+			else
+				cond.wait(lock, [&]{ return gen != generation; });
+		}
+
+		//! Wait for \p n threads from now on, releasing the waiting ones if they all arrived
+		void resize(std::size_t n){
+			std::lock_guard<std::mutex> lock(mutex);
+
+			numThreads = n;
+			if(numArrived >= numThreads){
+				numArrived = 0;
+				++generation;
+				cond.notify_all();
+			}
+		}
+
+		std::mutex mutex;
+		std::condition_variable cond;
+		std::size_t numThreads, numArrived = 0, generation = 0;
+	};
+
+	struct KeyHash{
+		std::size_t operator()(const std::vector<std::uint64_t> &key) const noexcept{
+			std::uint64_t h = 0xcbf29ce484222325ull;
+			for(auto v : key)
+				h = (h ^ v) * 0x100000001b3ull;
+
+			return static_cast<std::size_t>(h ^ (h >> 32));
+		}
+	};
+
+	//! Canonical code of an operand: the type pointer or, tagged in the low bit, the first equal request
+	std::uint64_t operandCode(const TypeBatch::Operand &op, const std::vector<std::uint32_t> &reps) noexcept{
+		if(op.type)
+			return reinterpret_cast<std::uintptr_t>(op.type);
+		else
+			return std::uint64_t(reps[static_cast<std::size_t>(op.request)]) << 1 | 1;
+	}
+
+	//! Get the type for request \p idx, whose operands were built into \p results at their first equal request
+	TypeHandle buildRequest(
+		TypeData &data, const TypeBatch &batch, std::size_t idx,
+		const std::vector<std::uint32_t> &reps, const std::vector<TypeHandle> &results
+	){
+		auto &&req = batch.requests[idx];
+
+		std::vector<TypeHandle> types;
+		types.reserve(req.numOperands);
+
+		for(std::uint32_t i = 0; i < req.numOperands; i++){
+			auto &&op = batch.operands[req.firstOperand + i];
+			types.emplace_back(op.type ? op.type : results[reps[static_cast<std::size_t>(op.request)]]);
+		}
+
+		switch(req.kind){
+			case TypeKind::tree: return getTreeType(data, types[0]);
+			case TypeKind::list: return getListType(data, types[0]);
+			case TypeKind::array: return getArrayType(data, types[0]);
+			case TypeKind::dynamicArray: return getDynamicArrayType(data, types[0]);
+			case TypeKind::staticArray: return getStaticArrayType(data, types[0], req.param);
+			case TypeKind::sum: return getSumType(data, std::move(types));
+			case TypeKind::product: return getProductType(data, std::move(types));
+
+			case TypeKind::function:{
+				auto result = types.back();
+				types.pop_back();
+				return getFunctionType(data, std::move(types), result);
+			}
+
+			default: return nullptr;
+		}
+	}
+}
+
+TypeRequest TypeBatch::add(TypeKind kind, std::uint64_t param, const std::vector<Operand> &ops){
+	for(auto &&op : ops){
+		if(!op.isRequest && !op.type)
+			throw std::runtime_error("batch requests can not have null inner types");
+		else if(op.isRequest && static_cast<std::size_t>(op.request) >= requests.size())
+			throw std::runtime_error("batch requests can only use the results of earlier requests");
+	}
+
+	auto id = static_cast<TypeRequest>(requests.size());
+
+	requests.emplace_back(Request{kind, param, static_cast<std::uint32_t>(operands.size()), static_cast<std::uint32_t>(ops.size())});
+	operands.insert(end(operands), begin(ops), end(ops));
+
+	return id;
+}
+
+TypeRequest TypeBatch::addProduct(const std::vector<Operand> &innerTypes){
+	if(innerTypes.size() < 2)
+		throw std::runtime_error("product type can not have less than 2 inner types");
+
+	return add(TypeKind::product, 0, innerTypes);
+}
+
+TypeRequest TypeBatch::addFunction(const std::vector<Operand> &params, Operand result){
+	auto ops = params;
+	ops.emplace_back(result);
+	return add(TypeKind::function, 0, ops);
+}
+
+std::vector<TypeHandle> ilang::getTypes(TypeData &data, const TypeBatch &batch, std::size_t numThreads){
+	auto n = batch.size();
+
+	// dedupe requests, giving each unique one a level one above its deepest dependency
+	std::vector<std::uint32_t> reps(n), levels(n, 0);
+	std::vector<std::vector<std::uint32_t>> byLevel;
+
+	std::unordered_map<std::vector<std::uint64_t>, std::uint32_t, KeyHash> uniques;
+	uniques.reserve(n);
+
+	std::vector<std::uint64_t> key;
+
+	for(std::size_t i = 0; i < n; i++){
+		auto &&req = batch.requests[i];
+
+		key.assign({static_cast<std::uint64_t>(req.kind), req.param});
+
+		std::uint32_t level = 0;
+
+		for(std::uint32_t j = 0; j < req.numOperands; j++){
+			auto &&op = batch.operands[req.firstOperand + j];
+			key.emplace_back(operandCode(op, reps));
+
+			if(!op.type)
+				level = std::max(level, levels[reps[static_cast<std::size_t>(op.request)]] + 1);
+		}
+
+		// inner types of a sum are unordered
+		if(req.kind == TypeKind::sum)
+			std::sort(begin(key) + 2, end(key));
+
+		auto res = uniques.emplace(key, static_cast<std::uint32_t>(i));
+		reps[i] = res.first->second;
+
+		if(res.second){
+			levels[i] = level;
+
+			if(byLevel.size() <= level)
+				byLevel.resize(level + 1);
+
+			byLevel[level].emplace_back(static_cast<std::uint32_t>(i));
+		}
+	}
+
+	reserveTypes(data, uniques.size());
+
+	std::vector<TypeHandle> results(n, nullptr);
+
+	// only a concurrent TypeData may be built from several threads, and more than there are requests per level never help
+	std::size_t maxThreads = 0;
+	for(auto &&level : byLevel)
+		maxThreads = std::max(maxThreads, level.size());
+
+	if(auto numCores = std::thread::hardware_concurrency())
+		maxThreads = std::min<std::size_t>(maxThreads, numCores);
+
+	numThreads = data.shards ? std::min(numThreads, maxThreads) : 1;
+
+	if(numThreads <= 1){
+		for(auto &&level : byLevel){
+			for(auto idx : level)
+				results[idx] = buildRequest(data, batch, idx, reps, results);
+		}
+	}
+	else{
+		// every thread works through each level, then waits for the others before starting the next
+		std::vector<std::atomic<std::size_t>> next(byLevel.size());
+		for(auto &&counter : next)
+			counter.store(0, std::memory_order_relaxed);
+
+		Barrier barrier(numThreads);
+
+		std::mutex errorMutex;
+		std::exception_ptr error;
+		std::atomic<bool> failed{false};
+
+		auto work = [&]{
+			for(std::size_t l = 0; l < byLevel.size(); l++){
+				auto &&level = byLevel[l];
+
+				for(std::size_t i; (i = next[l].fetch_add(1, std::memory_order_relaxed)) < level.size();){
+					// later requests may depend on the one that failed
+					if(failed.load(std::memory_order_relaxed))
+						break;
+
+					try{
+						results[level[i]] = buildRequest(data, batch, level[i], reps, results);
+					}
+					catch(...){
+						std::lock_guard<std::mutex> lock(errorMutex);
+						if(!error)
+							error = std::current_exception();
+
+						failed.store(true, std::memory_order_relaxed);
+					}
+				}
+
+				barrier.wait();
+			}
+		};
+
+		std::vector<std::thread> helpers;
+		helpers.reserve(numThreads - 1);
+
+		try{
+			for(std::size_t t = 1; t < numThreads; t++)
+				helpers.emplace_back(work);
+		}
+		catch(...){
+			// carry on with the helpers that did start, none of them passed the first barrier yet
+			barrier.resize(helpers.size() + 1);
+		}
+
+		work();
+
+		for(auto &&helper : helpers)
+			helper.join();
+
+		if(error)
+			std::rethrow_exception(error);
+	}
+
+	for(std::size_t i = 0; i < n; i++)
+		results[i] = results[reps[i]];
+
+	return results;
+}
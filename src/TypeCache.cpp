@@ -0,0 +1,172 @@
+#include <algorithm>
+
+#include "ilang/TypeCache.hpp"
+
+#include "TypeKeys.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Sized number families, to tell sized number keys of the same width apart
+	enum class NumberFamily: std::uint64_t{
+		complex, imaginary, real, rational, integer, natural, boolean
+	};
+
+	TypeKey makeNumberKey(NumberFamily family, std::uint32_t numBits) noexcept{
+		return TypeKey{TypeKind::sizedNumber, nullptr, 0, nullptr, static_cast<std::uint64_t>(family) << 32 | numBits};
+	}
+
+	bool entryMatches(const TypeCache::Entry &entry, std::uint64_t hash, const TypeKey &key) noexcept{
+		if(!entry.type || entry.hash != hash || entry.kind != key.kind || entry.param != key.param)
+			return false;
+
+		auto numTypes = key.numTypes + (key.result ? 1 : 0);
+		if(entry.numTypes != numTypes)
+			return false;
+
+		return std::equal(key.types, key.types + key.numTypes, entry.types)
+			&& (!key.result || entry.types[key.numTypes] == key.result);
+	}
+
+	/**
+	 * Look \p key up in \p cache, otherwise call \p fn and cache its result if it found a type.
+	 * Only pointers are compared, so a hit never reads the shared \ref TypeData.
+	 * Keys too large for an entry skip the cache and are only counted in \ref TypeCache::uncached.
+	 **/
+	template<typename Fn>
+	TypeHandle cached(TypeCache &cache, const TypeKey &key, Fn &&fn){
+		auto numTypes = key.numTypes + (key.result ? 1 : 0);
+		if(numTypes > TypeCache::maxKeyTypes){
+			++cache.uncached;
+			return fn();
+		}
+
+		auto hash = TypeInterner::hash(key);
+		auto &&entry = cache.entries[hash & (cache.entries.size() - 1)];
+
+		if(entryMatches(entry, hash, key)){
+			++cache.hits;
+			return entry.type;
+		}
+
+		++cache.misses;
+
+		auto type = fn();
+		if(type){
+			entry.type = type;
+			entry.hash = hash;
+			entry.param = key.param;
+			entry.kind = key.kind;
+			entry.numTypes = static_cast<std::uint8_t>(numTypes);
+
+			std::copy(key.types, key.types + key.numTypes, entry.types);
+			if(key.result)
+				entry.types[key.numTypes] = key.result;
+		}
+
+		return type;
+	}
+}
+
+TypeCache::TypeCache(TypeData &data_, std::size_t capacity)
+	: data(data_)
+{
+	std::size_t n = 1;
+	while(n < capacity) n *= 2;
+
+	entries.resize(n);
+}
+
+void TypeCache::clear() noexcept{
+	std::fill(begin(entries), end(entries), Entry{});
+	hits = misses = uncached = 0;
+}
+
+TypeHandle ilang::findStringType(TypeCache &cache, std::optional<StringEncoding> encoding){
+	if(!encoding)
+		return findStringType(cache.data);
+
+	auto key = TypeKey{TypeKind::string, nullptr, 0, nullptr, static_cast<std::uint64_t>(*encoding)};
+	return cached(cache, key, [&]{ return findStringType(cache.data, encoding); });
+}
+
+TypeHandle ilang::getStringType(TypeCache &cache, std::optional<StringEncoding> encoding){
+	if(!encoding)
+		return getStringType(cache.data);
+
+	auto key = TypeKey{TypeKind::string, nullptr, 0, nullptr, static_cast<std::uint64_t>(*encoding)};
+	return cached(cache, key, [&]{ return getStringType(cache.data, encoding); });
+}
+
+#define CACHED_INNER_TYPE(T, kind)\
+TypeHandle ilang::find##T##Type(TypeCache &cache, TypeHandle t){\
+	return cached(cache, makeInnerKey(TypeKind::kind, t), [&]{ return find##T##Type(cache.data, t); });\
+}\
+TypeHandle ilang::get##T##Type(TypeCache &cache, TypeHandle t){\
+	return cached(cache, makeInnerKey(TypeKind::kind, t), [&]{ return get##T##Type(cache.data, t); });\
+}
+
+CACHED_INNER_TYPE(Tree, tree)
+CACHED_INNER_TYPE(List, list)
+CACHED_INNER_TYPE(Array, array)
+CACHED_INNER_TYPE(DynamicArray, dynamicArray)
+
+TypeHandle ilang::findStaticArrayType(TypeCache &cache, TypeHandle t, std::size_t n){
+	return cached(cache, makeInnerKey(TypeKind::staticArray, t, n), [&]{ return findStaticArrayType(cache.data, t, n); });
+}
+
+TypeHandle ilang::getStaticArrayType(TypeCache &cache, TypeHandle t, std::size_t n){
+	return cached(cache, makeInnerKey(TypeKind::staticArray, t, n), [&]{ return getStaticArrayType(cache.data, t, n); });
+}
+
+#define CACHED_NUMBER_TYPE(T, family)\
+TypeHandle ilang::find##T##Type(TypeCache &cache, std::uint32_t numBits){\
+	if(!numBits) return find##T##Type(cache.data);\
+	return cached(cache, makeNumberKey(NumberFamily::family, numBits), [&]{ return find##T##Type(cache.data, numBits); });\
+}\
+TypeHandle ilang::get##T##Type(TypeCache &cache, std::uint32_t numBits){\
+	if(!numBits) return get##T##Type(cache.data);\
+	return cached(cache, makeNumberKey(NumberFamily::family, numBits), [&]{ return get##T##Type(cache.data, numBits); });\
+}
+
+CACHED_NUMBER_TYPE(Complex, complex)
+CACHED_NUMBER_TYPE(Imaginary, imaginary)
+CACHED_NUMBER_TYPE(Real, real)
+CACHED_NUMBER_TYPE(Rational, rational)
+CACHED_NUMBER_TYPE(Integer, integer)
+CACHED_NUMBER_TYPE(Natural, natural)
+CACHED_NUMBER_TYPE(Boolean, boolean)
+
+TypeHandle ilang::findSumType(TypeCache &cache, std::vector<TypeHandle> innerTypes){
+	sortInnerTypes(innerTypes);
+
+	auto key = makeListKey(TypeKind::sum, innerTypes);
+	return cached(cache, key, [&]{ return findSumType(cache.data, innerTypes); });
+}
+
+TypeHandle ilang::getSumType(TypeCache &cache, std::vector<TypeHandle> innerTypes){
+	sortInnerTypes(innerTypes);
+
+	auto key = makeListKey(TypeKind::sum, innerTypes);
+	return cached(cache, key, [&]{ return getSumType(cache.data, innerTypes); });
+}
+
+TypeHandle ilang::findProductType(TypeCache &cache, const std::vector<TypeHandle> &innerTypes){
+	auto key = makeListKey(TypeKind::product, innerTypes);
+	return cached(cache, key, [&]{ return findProductType(cache.data, innerTypes); });
+}
+
+TypeHandle ilang::getProductType(TypeCache &cache, std::vector<TypeHandle> innerTypes){
+	auto key = makeListKey(TypeKind::product, innerTypes);
+	return cached(cache, key, [&]{ return getProductType(cache.data, innerTypes); });
+}
+
+TypeHandle ilang::findFunctionType(TypeCache &cache, const std::vector<TypeHandle> &params, TypeHandle result){
+	auto key = makeFunctionKey(params, result);
+	return cached(cache, key, [&]{ return findFunctionType(cache.data, params, result); });
+}
+
+TypeHandle ilang::getFunctionType(TypeCache &cache, std::vector<TypeHandle> args, TypeHandle ret){
+	auto key = makeFunctionKey(args, ret);
+	return cached(cache, key, [&]{ return getFunctionType(cache.data, args, ret); });
+}
@@ -0,0 +1,43 @@
+#include <cstring>
+
+#include "ilang/TypeFormatting.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Format with \p fn into \p buffer, stopping at the first piece that does not fit
+	template<typename Fn>
+	FormatResult formatToBuffer(char *buffer, std::size_t size, const FormatOptions &options, Fn &&fn) noexcept{
+		FormatResult res;
+		if(size == 0){
+			res.truncated = true;
+			return res;
+		}
+
+		// leave room for the terminating null
+		auto capacity = size - 1;
+
+		auto write = [&](std::string_view str){
+			auto n = std::min(str.size(), capacity - res.size);
+			std::memcpy(buffer + res.size, str.data(), n);
+			res.size += n;
+
+			res.truncated = n < str.size();
+			return !res.truncated;
+		};
+
+		TypeFormatter<decltype(write)> formatter{write, options};
+		fn(formatter);
+
+		buffer[res.size] = '\0';
+		return res;
+	}
+}
+
+FormatResult ilang::formatTypeName(const TypeData&, TypeHandle type, char *buffer, std::size_t size, const FormatOptions &options) noexcept{
+	return formatToBuffer(buffer, size, options, [type](auto &formatter){ formatter.name(type); });
+}
+
+FormatResult ilang::formatMangledName(const TypeData&, TypeHandle type, char *buffer, std::size_t size, const FormatOptions &options) noexcept{
+	return formatToBuffer(buffer, size, options, [type](auto &formatter){ formatter.mangledName(type); });
+}
@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <unistd.h>
+
+#include "ilang/TypeIO.hpp"
+
+using namespace ilang;
+
+namespace {
+	constexpr char magic[4] = {'I', 'L', 'T', 'D'};
+
+	constexpr std::uint64_t maxAliasSize = 4096;
+
+	[[noreturn]] void malformed(const char *what){
+		throw std::runtime_error(std::string("malformed type data: ") + what);
+	}
+
+	TypeHandle readTypeId(FileReader &reader, const TypeData &data){
+		auto id = reader.readVarint();
+		if(id >= data.storage.size())
+			malformed("reference to a later type");
+
+		return data.storage[static_cast<std::size_t>(id)];
+	}
+
+	std::vector<TypeHandle> readTypeIds(FileReader &reader, const TypeData &data){
+		auto n = reader.readVarint();
+
+		// the count is not trusted for allocating, a bogus one runs into the end of the file instead
+		std::vector<TypeHandle> types;
+		types.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(n, 256)));
+
+		for(std::uint64_t i = 0; i < n; i++)
+			types.emplace_back(readTypeId(reader, data));
+
+		return types;
+	}
+
+	TypeHandle getSizedNumberType(TypeData &data, TypeHandle base, std::uint32_t numBits){
+		if(base == data.booleanType) return getBooleanType(data, numBits);
+		else if(base == data.naturalType) return getNaturalType(data, numBits);
+		else if(base == data.integerType) return getIntegerType(data, numBits);
+		else if(base == data.rationalType) return getRationalType(data, numBits);
+		else if(base == data.realType) return getRealType(data, numBits);
+		else if(base == data.imaginaryType) return getImaginaryType(data, numBits);
+		else if(base == data.complexType) return getComplexType(data, numBits);
+		else malformed("sized number of an unknown family");
+	}
+
+	//! Fields of a type record, as written by \ref writeTypeRecord
+	struct RecordFields{
+		TypeKind kind;
+
+		//! Family of a sized number
+		TypeHandle base = nullptr;
+
+		std::uint64_t param = 0;
+		std::vector<TypeHandle> types;
+	};
+
+	RecordFields readRecordFields(FileReader &reader, const TypeData &data){
+		RecordFields rec;
+		rec.kind = static_cast<TypeKind>(reader.readByte());
+
+		switch(rec.kind){
+			case TypeKind::sizedNumber:
+				rec.base = readTypeId(reader, data);
+				rec.param = reader.readVarint();
+				if(!rec.param) malformed("sized number without a size");
+				if(rec.param > UINT32_MAX) malformed("sized number too large");
+				break;
+
+			case TypeKind::string:
+				rec.param = reader.readVarint();
+				if(rec.param > static_cast<std::uint64_t>(StringEncoding::utf8)) malformed("unknown string encoding");
+				break;
+
+			case TypeKind::partial: break;
+
+			case TypeKind::tree:
+			case TypeKind::list:
+			case TypeKind::array:
+			case TypeKind::dynamicArray:
+				rec.types.emplace_back(readTypeId(reader, data));
+				break;
+
+			case TypeKind::staticArray:
+				rec.types.emplace_back(readTypeId(reader, data));
+				rec.param = reader.readVarint();
+				break;
+
+			case TypeKind::sum: rec.types = readTypeIds(reader, data); break;
+
+			case TypeKind::product:
+				rec.types = readTypeIds(reader, data);
+				if(rec.types.size() < 2) malformed("product of less than 2 types");
+				break;
+
+			case TypeKind::function:
+				rec.types = readTypeIds(reader, data);
+				if(rec.types.empty()) malformed("function without a result");
+				break;
+
+			default: malformed("unknown type kind");
+		}
+
+		return rec;
+	}
+}
+
+FileWriter::FileWriter(int fd_, std::size_t bufferSize)
+	: fd(fd_), buffer(bufferSize){}
+
+void FileWriter::write(const void *bytes, std::size_t n){
+	auto p = static_cast<const char*>(bytes);
+
+	while(n > 0){
+		if(len == buffer.size())
+			flush();
+
+		auto chunk = std::min(n, buffer.size() - len);
+		std::memcpy(buffer.data() + len, p, chunk);
+
+		len += chunk;
+		p += chunk;
+		n -= chunk;
+	}
+}
+
+void FileWriter::writeByte(std::uint8_t byte){
+	if(len == buffer.size())
+		flush();
+
+	buffer[len++] = static_cast<char>(byte);
+}
+
+void FileWriter::writeVarint(std::uint64_t value){
+	while(value >= 0x80){
+		writeByte(static_cast<std::uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+
+	writeByte(static_cast<std::uint8_t>(value));
+}
+
+void FileWriter::flush(){
+	std::size_t done = 0;
+
+	while(done < len){
+		auto res = ::write(fd, buffer.data() + done, len - done);
+		if(res < 0){
+			if(errno == EINTR) continue;
+			throw std::system_error(errno, std::generic_category(), "writing type data");
+		}
+
+		done += static_cast<std::size_t>(res);
+	}
+
+	len = 0;
+}
+
+FileReader::FileReader(int fd_, std::size_t bufferSize)
+	: fd(fd_), buffer(bufferSize){}
+
+bool FileReader::fill(){
+	pos = len = 0;
+
+	while(true){
+		auto res = ::read(fd, buffer.data(), buffer.size());
+		if(res < 0){
+			if(errno == EINTR) continue;
+			throw std::system_error(errno, std::generic_category(), "reading type data");
+		}
+
+		len = static_cast<std::size_t>(res);
+		numFilled += len;
+		return len > 0;
+	}
+}
+
+void FileReader::read(void *bytes, std::size_t n){
+	auto p = static_cast<char*>(bytes);
+
+	while(n > 0){
+		if(pos == len && !fill())
+			malformed("unexpected end of file");
+
+		auto chunk = std::min(n, len - pos);
+		std::memcpy(p, buffer.data() + pos, chunk);
+
+		pos += chunk;
+		p += chunk;
+		n -= chunk;
+	}
+}
+
+std::uint8_t FileReader::readByte(){
+	if(pos == len && !fill())
+		malformed("unexpected end of file");
+
+	return static_cast<std::uint8_t>(buffer[pos++]);
+}
+
+std::uint64_t FileReader::readVarint(){
+	std::uint64_t value = 0;
+
+	for(unsigned shift = 0; shift < 64; shift += 7){
+		auto byte = readByte();
+		value |= std::uint64_t(byte & 0x7f) << shift;
+
+		if(!(byte & 0x80))
+			return value;
+	}
+
+	malformed("varint too long");
+}
+
+bool FileReader::atEnd(){
+	return pos == len && !fill();
+}
+
+std::uint64_t ilang::hashPrelude(const TypeData &data){
+	std::uint64_t h = 0xcbf29ce484222325ull;
+
+	auto mix = [&h](const void *bytes, std::size_t n){
+		auto p = static_cast<const unsigned char*>(bytes);
+		for(std::size_t i = 0; i < n; i++)
+			h = (h ^ p[i]) * 0x100000001b3ull;
+	};
+
+	for(std::size_t id = 0; id < data.numPreludeTypes; id++){
+		auto type = data.storage[id];
+		auto baseId = type->base->id;
+
+		mix(&type->kind, sizeof(type->kind));
+		mix(&baseId, sizeof(baseId));
+		mix(&type->param, sizeof(type->param));
+		mix(type->mangled.data(), type->mangled.size() + 1);
+	}
+
+	return h;
+}
+
+void ilang::writeTypeRecord(FileWriter &writer, TypeHandle type){
+	writer.writeByte(static_cast<std::uint8_t>(type->kind));
+
+	switch(type->kind){
+		case TypeKind::sizedNumber:
+			writer.writeVarint(type->base->id);
+			writer.writeVarint(type->param);
+			break;
+
+		case TypeKind::string:
+			writer.writeVarint(type->param);
+			break;
+
+		case TypeKind::partial:
+			break;
+
+		case TypeKind::staticArray:
+			writer.writeVarint(type->types[0]->id);
+			writer.writeVarint(type->param);
+			break;
+
+		case TypeKind::tree:
+		case TypeKind::list:
+		case TypeKind::array:
+		case TypeKind::dynamicArray:
+			writer.writeVarint(type->types[0]->id);
+			break;
+
+		case TypeKind::sum:
+		case TypeKind::product:
+		case TypeKind::function:
+			writer.writeVarint(type->types.size());
+			for(auto inner : type->types)
+				writer.writeVarint(inner->id);
+			break;
+
+		default:
+			throw std::runtime_error("only types created after the prelude have records");
+	}
+}
+
+TypeHandle ilang::readTypeRecord(FileReader &reader, TypeData &data){
+	auto expectedId = data.storage.size();
+	auto rec = readRecordFields(reader, data);
+
+	TypeHandle type = nullptr;
+
+	switch(rec.kind){
+		case TypeKind::sizedNumber: type = getSizedNumberType(data, rec.base, static_cast<std::uint32_t>(rec.param)); break;
+		case TypeKind::string: type = getStringType(data, static_cast<StringEncoding>(rec.param)); break;
+		case TypeKind::partial: type = getPartialType(data); break;
+
+		case TypeKind::tree: type = getTreeType(data, rec.types[0]); break;
+		case TypeKind::list: type = getListType(data, rec.types[0]); break;
+		case TypeKind::array: type = getArrayType(data, rec.types[0]); break;
+		case TypeKind::dynamicArray: type = getDynamicArrayType(data, rec.types[0]); break;
+		case TypeKind::staticArray: type = getStaticArrayType(data, rec.types[0], static_cast<std::size_t>(rec.param)); break;
+
+		case TypeKind::sum: type = getSumType(data, std::move(rec.types)); break;
+		case TypeKind::product: type = getProductType(data, std::move(rec.types)); break;
+
+		default:{
+			auto result = rec.types.back();
+			rec.types.pop_back();
+			type = getFunctionType(data, std::move(rec.types), result);
+			break;
+		}
+	}
+
+	// an equal type already existing means the record was not written in creation order
+	if(type->id != expectedId)
+		malformed("type record out of order");
+
+	return type;
+}
+
+bool ilang::matchTypeRecord(FileReader &reader, const TypeData &data, TypeHandle type){
+	auto rec = readRecordFields(reader, data);
+
+	if(rec.kind != type->kind)
+		return false;
+
+	// partial types are numbered as they are created, their records only hold the kind
+	if(rec.kind == TypeKind::partial)
+		return true;
+
+	if(rec.param != type->param || (rec.base && rec.base != type->base))
+		return false;
+
+	return std::equal(begin(rec.types), end(rec.types), begin(type->types), end(type->types));
+}
+
+void ilang::writeTypeData(const TypeData &data, int fd){
+	FileWriter writer(fd);
+
+	auto numTypes = data.storage.size();
+
+	writer.write(magic, sizeof(magic));
+	writer.writeVarint(typeDataFormatVersion);
+	writer.writeVarint(data.numPreludeTypes);
+	writer.writeVarint(hashPrelude(data));
+	writer.writeVarint(numTypes);
+
+	for(auto id = data.numPreludeTypes; id < numTypes; id++)
+		writeTypeRecord(writer, data.storage[id]);
+
+	writer.writeVarint(data.typeAliases.size());
+	for(auto &&alias : data.typeAliases){
+		writer.writeVarint(alias.first.size());
+		writer.write(alias.first.data(), alias.first.size());
+		writer.writeVarint(alias.second->id);
+	}
+
+	writer.flush();
+}
+
+TypeData ilang::readTypeData(int fd, const TypeDataOptions &options){
+	FileReader reader(fd);
+
+	char fileMagic[sizeof(magic)];
+	reader.read(fileMagic, sizeof(fileMagic));
+	if(!std::equal(std::begin(magic), std::end(magic), fileMagic))
+		malformed("not type data");
+
+	if(reader.readVarint() != typeDataFormatVersion)
+		throw std::runtime_error("type data of another format version");
+
+	TypeData data(options);
+
+	auto numPreludeTypes = reader.readVarint();
+	auto hash = reader.readVarint();
+
+	if(numPreludeTypes != data.numPreludeTypes || hash != hashPrelude(data))
+		throw std::runtime_error("type data written with another prelude");
+
+	auto numTypes = reader.readVarint();
+	if(numTypes < numPreludeTypes || numTypes > invalidTypeId)
+		malformed("invalid number of types");
+
+	reserveTypes(data, static_cast<std::size_t>(numTypes - numPreludeTypes));
+
+	while(data.storage.size() < numTypes)
+		readTypeRecord(reader, data);
+
+	auto numAliases = reader.readVarint();
+	std::string name;
+
+	for(std::uint64_t i = 0; i < numAliases; i++){
+		auto len = reader.readVarint();
+		if(len > maxAliasSize) malformed("alias too long");
+
+		name.resize(static_cast<std::size_t>(len));
+		reader.read(name.data(), name.size());
+		data.typeAliases[name] = readTypeId(reader, data);
+	}
+
+	return data;
+}
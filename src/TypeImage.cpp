@@ -0,0 +1,530 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ilang/TypeIO.hpp"
+#include "ilang/TypeImage.hpp"
+
+using namespace ilang;
+
+namespace {
+	constexpr char magic[4] = {'I', 'L', 'T', 'I'};
+
+	constexpr TypeImage::Slot emptySlot = invalidTypeId;
+
+	//! Index of each family in \ref TypeImage::Header::numberFamilies
+	enum NumberFamily{
+		complexFamily, imaginaryFamily, realFamily, rationalFamily, integerFamily, naturalFamily, booleanFamily,
+		numNumberFamilies,
+
+		//! \ref TypeImage::Record::family of types that are not sized numbers
+		noFamily = 0xff
+	};
+
+	//! FNV-1a, hashes in an image must not change between processes
+	std::uint64_t hashName(std::string_view name) noexcept{
+		std::uint64_t h = 0xcbf29ce484222325ull;
+		for(auto c : name)
+			h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+
+		return h;
+	}
+
+	/**
+	 * \brief Hash the structure of a type
+	 *
+	 * \p result is hashed as the last of the \p types when non-null, like in a \ref TypeKey.
+	 **/
+	std::uint64_t hashStruct(
+		TypeKind kind, std::uint64_t param,
+		const TypeId *types, std::size_t numTypes, const TypeId *result = nullptr
+	) noexcept{
+		auto mix = [](std::uint64_t h, std::uint64_t v){
+			h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+			return h * 0xff51afd7ed558ccdull;
+		};
+
+		auto h = mix(static_cast<std::uint64_t>(kind), param);
+		for(std::size_t i = 0; i < numTypes; i++)
+			h = mix(h, types[i]);
+
+		if(result)
+			h = mix(h, *result);
+
+		return h ^ (h >> 32);
+	}
+
+	/**
+	 * \brief Find the id in \p slots whose hash is \p hash and that \p matches
+	 *
+	 * Same linear probing as \ref NameIndex, over slots in the image.
+	 **/
+	template<typename Matches>
+	TypeId findSlot(const TypeImage &image, std::uint64_t slotsOffset, std::uint32_t capacity, std::uint64_t hash, Matches &&matches) noexcept{
+		auto slots = reinterpret_cast<const TypeImage::Slot*>(image.bytes + slotsOffset);
+		auto mask = capacity - 1;
+		auto hash32 = static_cast<std::uint32_t>(hash);
+
+		for(auto i = hash32 & mask; ; i = (i + 1) & mask){
+			auto slot = slots[i];
+			auto id = static_cast<TypeId>(slot);
+
+			if(id == invalidTypeId)
+				return invalidTypeId;
+			else if(static_cast<std::uint32_t>(slot >> 32) == hash32 && matches(id))
+				return id;
+		}
+	}
+
+	//! Insert \p id unless \p matches finds an equal id already in \p slots
+	template<typename Matches>
+	void insertSlot(std::vector<TypeImage::Slot> &slots, std::uint64_t hash, TypeId id, Matches &&matches){
+		auto mask = slots.size() - 1;
+		auto hash32 = static_cast<std::uint32_t>(hash);
+		auto i = hash32 & mask;
+
+		for(TypeImage::Slot slot; (slot = slots[i]) != emptySlot; i = (i + 1) & mask){
+			if(static_cast<std::uint32_t>(slot >> 32) == hash32 && matches(static_cast<TypeId>(slot)))
+				return;
+		}
+
+		slots[i] = TypeImage::Slot(hash32) << 32 | id;
+	}
+
+	//! Capacity for \p n slots at a load factor of at most 1/2, images are written once and read often
+	std::uint32_t indexCapacity(std::size_t n){
+		std::size_t capacity = 16;
+		while(capacity < n * 2)
+			capacity *= 2;
+
+		if(capacity > UINT32_MAX)
+			throw std::runtime_error("too many types for an image");
+
+		return static_cast<std::uint32_t>(capacity);
+	}
+
+	TypeId findStruct(
+		const TypeImage &image, TypeKind kind, std::uint64_t param,
+		const TypeId *types, std::size_t numTypes, const TypeId *result = nullptr
+	) noexcept{
+		auto hash = hashStruct(kind, param, types, numTypes, result);
+		auto &&header = *image.header;
+
+		return findSlot(image, header.structIndexOffset, header.structIndexCapacity, hash, [&](TypeId id){
+			auto &&rec = image.record(id);
+			if(rec.kind != kind || rec.param != param || rec.numChildren != numTypes + (result ? 1 : 0))
+				return false;
+
+			auto children = image.childrenOf(id);
+			return std::equal(types, types + numTypes, begin(children)) && (!result || children.back() == *result);
+		});
+	}
+
+	TypeId findNumber(const TypeImage &image, NumberFamily family, std::uint32_t numBits) noexcept{
+		auto familyId = image.header->numberFamilies[family];
+		if(!numBits)
+			return familyId;
+
+		auto hash = hashStruct(TypeKind::sizedNumber, numBits, &familyId, 1);
+		auto &&header = *image.header;
+
+		return findSlot(image, header.structIndexOffset, header.structIndexCapacity, hash, [&](TypeId id){
+			auto &&rec = image.record(id);
+			return rec.kind == TypeKind::sizedNumber && rec.param == numBits && rec.family == family;
+		});
+	}
+
+	void checkSection(const TypeImage &image, std::uint64_t offset, std::uint64_t size){
+		if(offset % 8 != 0 || offset > image.size || size > image.size - offset)
+			throw std::runtime_error("malformed type image: section out of bounds");
+	}
+
+	void writePadding(FileWriter &writer, std::uint64_t &offset){
+		static constexpr char zeros[8] = {};
+
+		auto n = (8 - offset % 8) % 8;
+		writer.write(zeros, n);
+		offset += n;
+	}
+}
+
+TypeImage TypeImage::map(const char *path){
+	auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	if(fd < 0)
+		throw std::system_error(errno, std::generic_category(), "opening type image");
+
+	struct stat st;
+	if(::fstat(fd, &st) != 0){
+		auto err = errno;
+		::close(fd);
+		throw std::system_error(err, std::generic_category(), "opening type image");
+	}
+
+	auto size = static_cast<std::size_t>(st.st_size);
+	auto ptr = size ? ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+	auto err = errno;
+
+	// the mapping keeps the file alive
+	::close(fd);
+
+	if(ptr == MAP_FAILED){
+		if(!size)
+			throw std::runtime_error("malformed type image: empty file");
+
+		throw std::system_error(err, std::generic_category(), "mapping type image");
+	}
+
+	try{
+		TypeImage image(ptr, size);
+		image.mapped = true;
+		return image;
+	}
+	catch(...){
+		::munmap(ptr, size);
+		throw;
+	}
+}
+
+TypeImage::TypeImage(const void *bytes_, std::size_t size_)
+	: bytes(static_cast<const char*>(bytes_)), size(size_)
+{
+	if(reinterpret_cast<std::uintptr_t>(bytes) % 8 != 0)
+		throw std::runtime_error("type image must be aligned to 8 bytes");
+
+	if(size < sizeof(Header) || !std::equal(std::begin(magic), std::end(magic), bytes))
+		throw std::runtime_error("malformed type image: not a type image");
+
+	header = reinterpret_cast<const Header*>(bytes);
+
+	if(header->version != typeImageFormatVersion)
+		throw std::runtime_error("type image of another format version");
+
+	std::uint64_t numTypes = header->numTypes;
+
+	for(auto capacity : {header->nameIndexCapacity, header->mangledIndexCapacity, header->structIndexCapacity}){
+		if(!capacity || (capacity & (capacity - 1)))
+			throw std::runtime_error("malformed type image: index capacity not a power of two");
+	}
+
+	checkSection(*this, header->recordsOffset, numTypes * sizeof(Record));
+	checkSection(*this, header->stringsOffset, header->stringsSize);
+	checkSection(*this, header->aliasesOffset, std::uint64_t(header->numAliases) * sizeof(Alias));
+	checkSection(*this, header->nameIndexOffset, std::uint64_t(header->nameIndexCapacity) * sizeof(Slot));
+	checkSection(*this, header->mangledIndexOffset, std::uint64_t(header->mangledIndexCapacity) * sizeof(Slot));
+	checkSection(*this, header->structIndexOffset, std::uint64_t(header->structIndexCapacity) * sizeof(Slot));
+
+	// the id arrays run up to the next section
+	checkSection(*this, header->ancestorsOffset, header->childrenOffset - std::min(header->childrenOffset, header->ancestorsOffset));
+	checkSection(*this, header->childrenOffset, header->stringsOffset - std::min(header->stringsOffset, header->childrenOffset));
+
+	records = reinterpret_cast<const Record*>(bytes + header->recordsOffset);
+}
+
+TypeImage::TypeImage(TypeImage &&other) noexcept
+	: bytes(other.bytes), size(other.size), header(other.header), records(other.records), mapped(other.mapped)
+{
+	other.mapped = false;
+}
+
+TypeImage &TypeImage::operator=(TypeImage &&other) noexcept{
+	if(this != &other){
+		release();
+
+		bytes = other.bytes;
+		size = other.size;
+		header = other.header;
+		records = other.records;
+		mapped = other.mapped;
+
+		other.mapped = false;
+	}
+
+	return *this;
+}
+
+TypeImage::~TypeImage(){ release(); }
+
+void TypeImage::release() noexcept{
+	if(mapped)
+		::munmap(const_cast<char*>(bytes), size);
+
+	mapped = false;
+}
+
+void ilang::writeTypeImage(const TypeData &data, int fd){
+	auto n = data.storage.size();
+	if(n >= invalidTypeId)
+		throw std::runtime_error("too many types for an image");
+
+	std::vector<TypeImage::Record> records(n);
+	std::vector<TypeId> ancestors, children;
+
+	TypeHandle families[] = {
+		data.complexType, data.imaginaryType, data.realType, data.rationalType,
+		data.integerType, data.naturalType, data.booleanType
+	};
+
+	// the family of a sized number is the map it is found in, not its base
+	const TypeMap<std::uint32_t> *sizedFamilies[] = {
+		&data.sizedComplexTypes, &data.sizedImaginaryTypes, &data.sizedRealTypes, &data.sizedRationalTypes,
+		&data.sizedIntegerTypes, &data.sizedNaturalTypes, &data.sizedBooleanTypes
+	};
+
+	std::vector<std::uint8_t> familyOf(n, noFamily);
+	for(std::size_t i = 0; i < numNumberFamilies; i++)
+		sizedFamilies[i]->forEach([&](std::uint32_t, TypeHandle type){ familyOf[type->id] = static_cast<std::uint8_t>(i); });
+
+	// every distinct string once, as length, characters and a null terminator like an InternedString
+	std::vector<char> strings;
+	std::unordered_map<std::string_view, std::uint32_t> stringOffsets;
+
+	auto addString = [&](std::string_view str){
+		auto res = stringOffsets.emplace(str, 0);
+		if(res.second){
+			auto len = static_cast<std::uint32_t>(str.size());
+			auto at = strings.size();
+
+			strings.resize(at + sizeof(len) + str.size() + 1);
+			std::memcpy(strings.data() + at, &len, sizeof(len));
+			std::memcpy(strings.data() + at + sizeof(len), str.data(), str.size());
+
+			res.first->second = static_cast<std::uint32_t>(at + sizeof(len));
+		}
+
+		return res.first->second;
+	};
+
+	for(std::size_t id = 0; id < n; id++){
+		auto type = data.storage[id];
+		auto &&rec = records[id];
+
+		rec.base = type->base->id;
+		rec.depth = static_cast<std::uint32_t>(type->ancestors.size());
+		rec.firstAncestor = static_cast<std::uint32_t>(ancestors.size());
+		rec.firstChild = static_cast<std::uint32_t>(children.size());
+		rec.numChildren = static_cast<std::uint32_t>(type->types.size());
+		rec.flags = type->flags;
+		rec.param = type->param;
+		rec.name = addString(getTypeName(data, type));
+		rec.mangled = addString(getMangledName(data, type));
+		rec.kind = type->kind;
+		rec.family = familyOf[id];
+
+		for(auto ancestor : type->ancestors)
+			ancestors.emplace_back(ancestor->id);
+
+		for(auto inner : type->types)
+			children.emplace_back(inner->id);
+	}
+
+	if(strings.size() > UINT32_MAX || children.size() > UINT32_MAX || ancestors.size() > UINT32_MAX)
+		throw std::runtime_error("too many types for an image");
+
+	std::vector<TypeImage::Alias> aliases;
+	for(auto &&alias : data.typeAliases)
+		aliases.emplace_back(TypeImage::Alias{addString(alias.first), alias.second->id});
+
+	// the first type with a name wins, like in the name indices of the data
+	auto buildNameIndex = [&](std::uint32_t TypeImage::Record::*name){
+		std::vector<TypeImage::Slot> slots(indexCapacity(n), emptySlot);
+		auto nameAt = [&](std::uint32_t offset){
+			std::uint32_t len;
+			std::memcpy(&len, strings.data() + offset - sizeof(len), sizeof(len));
+			return std::string_view(strings.data() + offset, len);
+		};
+
+		for(std::size_t id = 0; id < n; id++){
+			auto str = nameAt(records[id].*name);
+			insertSlot(slots, hashName(str), static_cast<TypeId>(id), [&](TypeId other){ return nameAt(records[other].*name) == str; });
+		}
+
+		return slots;
+	};
+
+	auto nameSlots = buildNameIndex(&TypeImage::Record::name);
+	auto mangledSlots = buildNameIndex(&TypeImage::Record::mangled);
+
+	// compound types by kind, parameter and children; sized numbers by width and family
+	std::vector<TypeImage::Slot> structSlots(indexCapacity(n), emptySlot);
+
+	for(std::size_t id = 0; id < n; id++){
+		auto type = data.storage[id];
+		auto &&rec = records[id];
+
+		if(type->kind == TypeKind::sizedNumber && rec.family != noFamily){
+			auto family = families[rec.family]->id;
+			insertSlot(structSlots, hashStruct(rec.kind, rec.param, &family, 1), static_cast<TypeId>(id), [](TypeId){ return false; });
+		}
+		else if(isCompoundType(type)){
+			auto hash = hashStruct(rec.kind, rec.param, children.data() + rec.firstChild, rec.numChildren);
+			insertSlot(structSlots, hash, static_cast<TypeId>(id), [](TypeId){ return false; });
+		}
+	}
+
+	TypeImage::Header header = {};
+	std::copy(std::begin(magic), std::end(magic), header.magic);
+	header.version = typeImageFormatVersion;
+	header.numTypes = static_cast<std::uint32_t>(n);
+	header.numAliases = static_cast<std::uint32_t>(aliases.size());
+
+	for(std::size_t i = 0; i < numNumberFamilies; i++)
+		header.numberFamilies[i] = families[i]->id;
+
+	header.nameIndexCapacity = static_cast<std::uint32_t>(nameSlots.size());
+	header.mangledIndexCapacity = static_cast<std::uint32_t>(mangledSlots.size());
+	header.structIndexCapacity = static_cast<std::uint32_t>(structSlots.size());
+
+	// sections follow the header in this order, each aligned to 8 bytes
+	std::uint64_t offset = sizeof(header);
+	auto place = [&offset](std::uint64_t &at, std::uint64_t size){
+		at = offset;
+		offset += (size + 7) / 8 * 8;
+	};
+
+	place(header.recordsOffset, records.size() * sizeof(TypeImage::Record));
+	place(header.ancestorsOffset, ancestors.size() * sizeof(TypeId));
+	place(header.childrenOffset, children.size() * sizeof(TypeId));
+	place(header.stringsOffset, strings.size());
+	header.stringsSize = strings.size();
+	place(header.aliasesOffset, aliases.size() * sizeof(TypeImage::Alias));
+	place(header.nameIndexOffset, nameSlots.size() * sizeof(TypeImage::Slot));
+	place(header.mangledIndexOffset, mangledSlots.size() * sizeof(TypeImage::Slot));
+	place(header.structIndexOffset, structSlots.size() * sizeof(TypeImage::Slot));
+
+	FileWriter writer(fd);
+	std::uint64_t written = 0;
+
+	auto writeSection = [&](const void *bytes, std::uint64_t size){
+		writer.write(bytes, size);
+		written += size;
+		writePadding(writer, written);
+	};
+
+	writeSection(&header, sizeof(header));
+	writeSection(records.data(), records.size() * sizeof(TypeImage::Record));
+	writeSection(ancestors.data(), ancestors.size() * sizeof(TypeId));
+	writeSection(children.data(), children.size() * sizeof(TypeId));
+	writeSection(strings.data(), strings.size());
+	writeSection(aliases.data(), aliases.size() * sizeof(TypeImage::Alias));
+	writeSection(nameSlots.data(), nameSlots.size() * sizeof(TypeImage::Slot));
+	writeSection(mangledSlots.data(), mangledSlots.size() * sizeof(TypeImage::Slot));
+	writeSection(structSlots.data(), structSlots.size() * sizeof(TypeImage::Slot));
+
+	writer.flush();
+}
+
+InternedString ilang::getTypeName(const TypeImage &image, TypeId type) noexcept{
+	return image.string(image.record(type).name);
+}
+
+InternedString ilang::getMangledName(const TypeImage &image, TypeId type) noexcept{
+	return image.string(image.record(type).mangled);
+}
+
+bool ilang::hasBaseType(const TypeImage &image, TypeId type, TypeId baseType) noexcept{
+	// Infinity has id 0 and is the base of every type
+	if(baseType == 0)
+		return true;
+
+	auto depth = image.record(baseType).depth;
+	return depth < image.record(type).depth && image.ancestorsOf(type)[depth] == baseType;
+}
+
+TypeId ilang::findTypeByString(const TypeImage &image, std::string_view str) noexcept{
+	auto &&header = *image.header;
+
+	auto aliases = reinterpret_cast<const TypeImage::Alias*>(image.bytes + header.aliasesOffset);
+	auto aliasesEnd = aliases + header.numAliases;
+
+	auto aliased = std::lower_bound(aliases, aliasesEnd, str, [&](const TypeImage::Alias &alias, std::string_view name){
+		return image.string(alias.name).view() < name;
+	});
+
+	if(aliased != aliasesEnd && image.string(aliased->name) == str)
+		return aliased->type;
+
+	return findSlot(image, header.nameIndexOffset, header.nameIndexCapacity, hashName(str), [&](TypeId id){
+		return getTypeName(image, id) == str;
+	});
+}
+
+TypeId ilang::findTypeByMangled(const TypeImage &image, std::string_view mangled) noexcept{
+	auto &&header = *image.header;
+
+	return findSlot(image, header.mangledIndexOffset, header.mangledIndexCapacity, hashName(mangled), [&](TypeId id){
+		return getMangledName(image, id) == mangled;
+	});
+}
+
+TypeId ilang::findCommonType(const TypeImage &image, TypeId type0, TypeId type1) noexcept{
+	if(type0 == type1)
+		return type0;
+
+	// same binary search over the paths from Infinity as for handles
+	auto path0 = image.ancestorsOf(type0), path1 = image.ancestorsOf(type1);
+	auto at0 = [&](std::size_t d){ return d < path0.size() ? path0[d] : type0; };
+	auto at1 = [&](std::size_t d){ return d < path1.size() ? path1[d] : type1; };
+
+	std::size_t lo = 0, hi = std::min(path0.size(), path1.size());
+
+	while(lo < hi){
+		auto mid = lo + (hi - lo + 1) / 2;
+		if(at0(mid) == at1(mid))
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	return at0(lo);
+}
+
+#define IMAGE_INNER_TYPE(T, kind)\
+TypeId ilang::find##T##Type(const TypeImage &image, TypeId t) noexcept{\
+	return findStruct(image, TypeKind::kind, 0, &t, 1);\
+}
+
+IMAGE_INNER_TYPE(Tree, tree)
+IMAGE_INNER_TYPE(List, list)
+IMAGE_INNER_TYPE(Array, array)
+IMAGE_INNER_TYPE(DynamicArray, dynamicArray)
+
+TypeId ilang::findStaticArrayType(const TypeImage &image, TypeId t, std::size_t n) noexcept{
+	return findStruct(image, TypeKind::staticArray, n, &t, 1);
+}
+
+#define IMAGE_NUMBER_TYPE(T, family)\
+TypeId ilang::find##T##Type(const TypeImage &image, std::uint32_t numBits) noexcept{\
+	return findNumber(image, family##Family, numBits);\
+}
+
+IMAGE_NUMBER_TYPE(Complex, complex)
+IMAGE_NUMBER_TYPE(Imaginary, imaginary)
+IMAGE_NUMBER_TYPE(Real, real)
+IMAGE_NUMBER_TYPE(Rational, rational)
+IMAGE_NUMBER_TYPE(Integer, integer)
+IMAGE_NUMBER_TYPE(Natural, natural)
+IMAGE_NUMBER_TYPE(Boolean, boolean)
+
+TypeId ilang::findSumType(const TypeImage &image, std::vector<TypeId> innerTypes) noexcept{
+	// inner types of sums are ordered by id
+	std::sort(begin(innerTypes), end(innerTypes));
+	innerTypes.erase(std::unique(begin(innerTypes), end(innerTypes)), end(innerTypes));
+
+	return findStruct(image, TypeKind::sum, 0, innerTypes.data(), innerTypes.size());
+}
+
+TypeId ilang::findProductType(const TypeImage &image, const std::vector<TypeId> &innerTypes) noexcept{
+	return findStruct(image, TypeKind::product, 0, innerTypes.data(), innerTypes.size());
+}
+
+TypeId ilang::findFunctionType(const TypeImage &image, const std::vector<TypeId> &params, TypeId result) noexcept{
+	return findStruct(image, TypeKind::function, 0, params.data(), params.size(), &result);
+}
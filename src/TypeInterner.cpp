@@ -0,0 +1,123 @@
+#include <algorithm>
+
+#include "ilang/Type.hpp"
+
+using namespace ilang;
+
+namespace {
+	constexpr std::size_t minInternerCapacity = 64;
+
+	inline std::uint64_t mixHash(std::uint64_t h, std::uint64_t v) noexcept{
+		h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+		h *= 0xff51afd7ed558ccdull;
+		return h ^ (h >> 32);
+	}
+
+	bool keyMatches(const TypeTable &table, TypeId id, const TypeKey &key) noexcept{
+		if(table.kinds[id] != key.kind || table.params[id] != key.param)
+			return false;
+
+		auto children = table.childrenOf(id);
+
+		auto numTypes = key.numTypes + (key.result ? 1 : 0);
+		if(children.size() != numTypes)
+			return false;
+
+		for(std::size_t i = 0; i < key.numTypes; i++){
+			if(children[i] != key.types[i]->id)
+				return false;
+		}
+
+		return !key.result || children.back() == key.result->id;
+	}
+}
+
+std::uint64_t TypeInterner::hash(const TypeKey &key) noexcept{
+	auto h = mixHash(static_cast<std::uint64_t>(key.kind), key.param);
+
+	for(std::size_t i = 0; i < key.numTypes; i++)
+		h = mixHash(h, reinterpret_cast<std::uintptr_t>(key.types[i]));
+
+	if(key.result)
+		h = mixHash(h, reinterpret_cast<std::uintptr_t>(key.result));
+
+	return h;
+}
+
+TypeInterner::Table::Table(std::size_t n)
+	: capacity(n), slots(new std::atomic<Slot>[n])
+{
+	for(std::size_t i = 0; i < n; i++)
+		slots[i].store(emptySlot, std::memory_order_relaxed);
+}
+
+TypeHandle TypeInterner::find(const TypeData &data, const TypeKey &key, std::uint64_t keyHash) const noexcept{
+	auto tbl = table.load();
+	if(!tbl)
+		return nullptr;
+
+	auto mask = tbl->capacity - 1;
+	auto hash32 = static_cast<std::uint32_t>(keyHash);
+
+	for(auto i = hash32 & mask; ; i = (i + 1) & mask){
+		// the type's row is stored before its slot, so it is visible once the slot is
+		auto slot = tbl->slots[i].load(std::memory_order_acquire);
+		auto id = static_cast<TypeId>(slot);
+
+		if(id == invalidTypeId)
+			return nullptr;
+		else if(static_cast<std::uint32_t>(slot >> 32) == hash32 && keyMatches(data.table, id, key))
+			return data.storage[id];
+	}
+}
+
+void TypeInterner::insert(TypeHandle type, std::uint64_t keyHash){
+	reserve(count + 1);
+
+	auto tbl = table.load();
+	auto mask = tbl->capacity - 1;
+	auto hash32 = static_cast<std::uint32_t>(keyHash);
+	auto i = hash32 & mask;
+
+	while(tbl->slots[i].load(std::memory_order_relaxed) != emptySlot)
+		i = (i + 1) & mask;
+
+	tbl->slots[i].store(Slot(hash32) << 32 | type->id, std::memory_order_release);
+	++count;
+}
+
+void TypeInterner::reserve(std::size_t n){
+	auto old = table.load();
+
+	// keep the load factor at or below 3/4
+	auto required = n + n / 3 + 1;
+	if(old && required <= old->capacity)
+		return;
+
+	auto capacity = std::max(old ? old->capacity * 2 : 0, minInternerCapacity);
+	while(capacity < required)
+		capacity *= 2;
+
+	auto tbl = std::make_unique<Table>(capacity);
+	auto mask = capacity - 1;
+
+	for(std::size_t j = 0; old && j < old->capacity; j++){
+		auto slot = old->slots[j].load(std::memory_order_relaxed);
+		if(slot == emptySlot) continue;
+
+		auto i = static_cast<std::uint32_t>(slot >> 32) & mask;
+		while(tbl->slots[i].load(std::memory_order_relaxed) != emptySlot)
+			i = (i + 1) & mask;
+
+		tbl->slots[i].store(slot, std::memory_order_relaxed);
+	}
+
+	// readers still probing the old table miss only types inserted from now on
+	table.publish(std::move(tbl));
+}
+
+std::size_t TypeInterner::bytesAllocated() const noexcept{
+	std::size_t n = 0;
+	table.forEachVersion([&n](const Table &tbl){ n += sizeof(Table) + sizeof(Slot) * tbl.capacity; });
+	return n;
+}
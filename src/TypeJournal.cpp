@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ilang/TypeJournal.hpp"
+
+using namespace ilang;
+
+namespace {
+	constexpr char magic[4] = {'I', 'L', 'T', 'J'};
+
+	[[noreturn]] void throwErrno(const char *what){
+		throw std::system_error(errno, std::generic_category(), what);
+	}
+
+	void writeHeader(TypeJournal &journal){
+		FileWriter writer(journal.fd, 64);
+
+		writer.write(magic, sizeof(magic));
+		writer.writeVarint(typeDataFormatVersion);
+		writer.writeVarint(hashPrelude(journal.data));
+		writer.writeVarint(journal.numBaseTypes);
+		writer.flush();
+	}
+
+	//! Replay the records after the header, returns the offset just past the last complete one
+	std::uint64_t replay(TypeJournal &journal, FileReader &reader){
+		auto good = reader.offset();
+
+		while(!reader.atEnd()){
+			auto numTypes = journal.data.storage.size();
+
+			try{
+				readTypeRecord(reader, journal.data);
+			}
+			catch(const std::system_error&){
+				throw;
+			}
+			catch(const std::runtime_error&){
+				// only the last record may be incomplete, after a crash while it was appended
+				if(!reader.atEnd() || journal.data.storage.size() != numTypes)
+					throw;
+
+				break;
+			}
+
+			good = reader.offset();
+			++journal.numReplayed;
+		}
+
+		return good;
+	}
+
+	/**
+	 * \brief Check the records after the header against the types \p data already has
+	 *
+	 * Used for a journal left over from a compaction whose snapshot is in place, which must hold every record.
+	 **/
+	void checkCovered(TypeJournal &journal, FileReader &reader){
+		auto &&data = journal.data;
+		auto id = journal.numBaseTypes;
+
+		while(!reader.atEnd()){
+			if(id >= data.storage.size())
+				throw std::runtime_error("type journal has types past its snapshot");
+
+			bool matches;
+
+			try{
+				matches = matchTypeRecord(reader, data, data.storage[id]);
+			}
+			catch(const std::system_error&){
+				throw;
+			}
+			catch(const std::runtime_error&){
+				// a record torn by a crash was never part of the journal
+				if(!reader.atEnd())
+					throw;
+
+				break;
+			}
+
+			if(!matches)
+				throw std::runtime_error("type journal does not match these types");
+
+			++id;
+		}
+	}
+}
+
+TypeJournal::TypeJournal(TypeData &data_, int fd_)
+	: data(data_), fd(fd_)
+{
+	struct stat st;
+	if(::fstat(fd, &st) != 0)
+		throwErrno("opening type journal");
+
+	if(st.st_size == 0){
+		restartJournal(*this);
+		return;
+	}
+
+	if(::lseek(fd, 0, SEEK_SET) < 0)
+		throwErrno("opening type journal");
+
+	FileReader reader(fd);
+
+	char fileMagic[sizeof(magic)];
+	reader.read(fileMagic, sizeof(fileMagic));
+	if(!std::equal(std::begin(magic), std::end(magic), fileMagic))
+		throw std::runtime_error("malformed type journal: not a type journal");
+
+	if(reader.readVarint() != typeDataFormatVersion)
+		throw std::runtime_error("type journal of another format version");
+
+	if(reader.readVarint() != hashPrelude(data))
+		throw std::runtime_error("type journal written with another prelude");
+
+	numBaseTypes = static_cast<std::size_t>(reader.readVarint());
+
+	if(numBaseTypes < data.numPreludeTypes)
+		throw std::runtime_error("malformed type journal: starts inside the prelude");
+
+	// a compaction that committed its snapshot but crashed before restarting the journal
+	if(numBaseTypes < data.storage.size()){
+		checkCovered(*this, reader);
+		restartJournal(*this);
+		return;
+	}
+	else if(numBaseTypes > data.storage.size())
+		throw std::runtime_error("type journal does not continue these types");
+
+	auto end = replay(*this, reader);
+	numPersisted = data.storage.size();
+
+	// continue right after the last complete record
+	if(static_cast<std::uint64_t>(st.st_size) != end && ::ftruncate(fd, static_cast<off_t>(end)) != 0)
+		throwErrno("truncating type journal");
+
+	if(::lseek(fd, static_cast<off_t>(end), SEEK_SET) < 0)
+		throwErrno("opening type journal");
+}
+
+std::size_t ilang::writeJournal(TypeJournal &journal, bool durable){
+	auto numTypes = journal.data.storage.size();
+	if(numTypes == journal.numPersisted)
+		return 0;
+
+	// a failed append is cut off again, so the journal never keeps a partial batch
+	auto start = ::lseek(journal.fd, 0, SEEK_CUR);
+	if(start < 0)
+		throwErrno("appending to type journal");
+
+	try{
+		FileWriter writer(journal.fd);
+
+		for(auto id = journal.numPersisted; id < numTypes; id++)
+			writeTypeRecord(writer, journal.data.storage[id]);
+
+		writer.flush();
+
+		if(durable && ::fdatasync(journal.fd) != 0)
+			throwErrno("syncing type journal");
+	}
+	catch(...){
+		// best effort, the original error is the one worth reporting
+		if(::ftruncate(journal.fd, start) == 0)
+			::lseek(journal.fd, start, SEEK_SET);
+
+		throw;
+	}
+
+	auto numWritten = numTypes - journal.numPersisted;
+	journal.numPersisted = numTypes;
+	return numWritten;
+}
+
+void ilang::writeJournalSnapshot(const TypeJournal &journal, int snapshotFd){
+	writeTypeData(journal.data, snapshotFd);
+
+	if(::fdatasync(snapshotFd) != 0)
+		throwErrno("syncing type snapshot");
+}
+
+void ilang::restartJournal(TypeJournal &journal){
+	if(::ftruncate(journal.fd, 0) != 0 || ::lseek(journal.fd, 0, SEEK_SET) < 0)
+		throwErrno("truncating type journal");
+
+	journal.numBaseTypes = journal.numPersisted = journal.data.storage.size();
+	journal.numReplayed = 0;
+
+	writeHeader(journal);
+}
@@ -0,0 +1,33 @@
+#ifndef ILANG_SRC_TYPEKEYS_HPP
+#define ILANG_SRC_TYPEKEYS_HPP 1
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "ilang/Type.hpp"
+
+namespace ilang{
+	//! Key of a compound type of \p kind over the single inner type \p t
+	inline TypeKey makeInnerKey(TypeKind kind, const TypeHandle &t, std::uint64_t param = 0) noexcept{
+		return TypeKey{kind, &t, 1, nullptr, param};
+	}
+
+	//! Key of a compound type of \p kind over the list of inner \p types
+	inline TypeKey makeListKey(TypeKind kind, const std::vector<TypeHandle> &types) noexcept{
+		return TypeKey{kind, types.data(), types.size()};
+	}
+
+	//! Key of the function type from \p params to \p result
+	inline TypeKey makeFunctionKey(const std::vector<TypeHandle> &params, TypeHandle result) noexcept{
+		return TypeKey{TypeKind::function, params.data(), params.size(), result};
+	}
+
+	//! Put the inner types of a sum type in canonical order: by id, so it is the same in every process
+	inline void sortInnerTypes(std::vector<TypeHandle> &innerTypes){
+		std::sort(begin(innerTypes), end(innerTypes), [](TypeHandle lhs, TypeHandle rhs){ return lhs->id < rhs->id; });
+		innerTypes.erase(std::unique(begin(innerTypes), end(innerTypes)), end(innerTypes));
+	}
+}
+
+#endif // !ILANG_SRC_TYPEKEYS_HPP
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "ilang/TypeMangling.hpp"
+#include "ilang/TypeTrace.hpp"
+
+#include "InnerTypes.hpp"
+#include "RecordCall.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Deepest nesting decoded, so malicious names can not exhaust the stack
+	constexpr std::size_t maxDepth = 256;
+
+	/**
+	 * \brief Recursive descent decoder over a mangled name
+	 *
+	 * Finds types in a const \p Data and gets them otherwise.
+	 **/
+	template<typename Data>
+	struct Demangler{
+		static constexpr bool creates = !std::is_const_v<Data>;
+
+		Data &data;
+		const char *p, *end;
+		std::size_t depth = 0;
+
+		bool eat(char c) noexcept{
+			if(p == end || *p != c)
+				return false;
+
+			++p;
+			return true;
+		}
+
+		//! Decode a number without leading zeros
+		bool number(std::uint64_t &n) noexcept{
+			if(p == end || *p < '0' || *p > '9')
+				return false;
+
+			n = 0;
+
+			if(*p == '0'){
+				++p;
+				return true;
+			}
+
+			for(; p != end && *p >= '0' && *p <= '9'; ++p){
+				auto digit = static_cast<std::uint64_t>(*p - '0');
+				if(n > (UINT64_MAX - digit) / 10)
+					return false;
+
+				n = n * 10 + digit;
+			}
+
+			return true;
+		}
+
+		TypeHandle type(){
+			if(depth == maxDepth)
+				return nullptr;
+
+			++depth;
+			auto res = decode();
+			--depth;
+			return res;
+		}
+
+		//! Decode \p n inner types into \p types, returns false if any could not be found
+		bool innerTypes(std::uint64_t n, InnerTypes &types){
+			for(std::uint64_t i = 0; i < n; i++){
+				auto inner = type();
+				if(!inner)
+					return false;
+
+				types.push(inner);
+			}
+
+			return true;
+		}
+
+		TypeHandle sizedNumber(char family){
+			if(eat('?')){
+				switch(family){
+					case 'c': return data.complexType;
+					case 'i': return data.imaginaryType;
+					case 'r': return data.realType;
+					case 'q': return data.rationalType;
+					case 'z': return data.integerType;
+					case 'n': return data.naturalType;
+					default: return data.booleanType;
+				}
+			}
+
+			std::uint64_t numBits;
+			if(!number(numBits) || numBits == 0 || numBits > UINT32_MAX)
+				return nullptr;
+
+			auto bits = static_cast<std::uint32_t>(numBits);
+
+		#define DEMANGLE_NUMBER(c, T)\
+			case c:\
+				if constexpr(creates) return get##T##Type(data, bits);\
+				else return find##T##Type(data, bits);
+
+			switch(family){
+				DEMANGLE_NUMBER('c', Complex)
+				DEMANGLE_NUMBER('i', Imaginary)
+				DEMANGLE_NUMBER('r', Real)
+				DEMANGLE_NUMBER('q', Rational)
+				DEMANGLE_NUMBER('z', Integer)
+				DEMANGLE_NUMBER('n', Natural)
+				DEMANGLE_NUMBER('b', Boolean)
+				default: return nullptr;
+			}
+
+		#undef DEMANGLE_NUMBER
+		}
+
+		TypeHandle string(){
+			std::optional<StringEncoding> encoding;
+
+			if(eat('?'))
+				return data.stringType;
+			else if(eat('a') && eat('8'))
+				encoding = StringEncoding::ascii;
+			else if(eat('u') && eat('8'))
+				encoding = StringEncoding::utf8;
+			else
+				return nullptr;
+
+			if constexpr(creates) return getStringType(data, encoding);
+			else return findStringType(data, encoding);
+		}
+
+		//! Tree, List or Array after the 'o'
+		TypeHandle object(){
+			char kind = p != end ? *p++ : 0;
+			if(!eat('0'))
+				return nullptr;
+
+			auto inner = type();
+			if(!inner)
+				return nullptr;
+
+		#define DEMANGLE_OBJECT(c, T)\
+			case c:\
+				if constexpr(creates) return get##T##Type(data, inner);\
+				else return find##T##Type(data, inner);
+
+			switch(kind){
+				DEMANGLE_OBJECT('t', Tree)
+				DEMANGLE_OBJECT('l', List)
+				DEMANGLE_OBJECT('a', Array)
+				default: return nullptr;
+			}
+
+		#undef DEMANGLE_OBJECT
+		}
+
+		TypeHandle array(){
+			if(eat('d')){
+				auto inner = type();
+				if(!inner) return nullptr;
+
+				if constexpr(creates) return getDynamicArrayType(data, inner);
+				else return findDynamicArrayType(data, inner);
+			}
+
+			std::uint64_t n;
+			if(!number(n))
+				return nullptr;
+
+			auto inner = type();
+			if(!inner) return nullptr;
+
+			if constexpr(creates) return getStaticArrayType(data, inner, static_cast<std::size_t>(n));
+			else return findStaticArrayType(data, inner, static_cast<std::size_t>(n));
+		}
+
+		TypeHandle sum(){
+			std::uint64_t n;
+			InnerTypes types;
+
+			if(!number(n) || !innerTypes(n, types))
+				return nullptr;
+
+			if constexpr(creates)
+				return getSumType(data, types.vector());
+			else{
+				// inner types are interned in id order
+				auto first = types.data(), last = first + types.size();
+				std::sort(first, last, [](TypeHandle lhs, TypeHandle rhs){ return lhs->id < rhs->id; });
+				last = std::unique(first, last);
+
+				return findCompoundType(data, TypeKey{TypeKind::sum, first, static_cast<std::size_t>(last - first)});
+			}
+		}
+
+		TypeHandle product(){
+			if(eat('0'))
+				return data.unitType;
+
+			std::uint64_t n;
+			InnerTypes types;
+
+			if(!number(n) || n < 2 || !innerTypes(n, types))
+				return nullptr;
+
+			if constexpr(creates) return getProductType(data, types.vector());
+			else return findCompoundType(data, TypeKey{TypeKind::product, types.data(), types.size()});
+		}
+
+		TypeHandle function(){
+			if(eat('?'))
+				return data.functionType;
+
+			std::uint64_t n;
+			if(!number(n))
+				return nullptr;
+
+			auto result = type();
+			InnerTypes params;
+
+			if(!result || !innerTypes(n, params))
+				return nullptr;
+
+			if constexpr(creates) return getFunctionType(data, params.vector(), result);
+			else return findCompoundType(data, TypeKey{TypeKind::function, params.data(), params.size(), result});
+		}
+
+		TypeHandle partial(){
+			if(eat('?'))
+				return data.partialType;
+
+			std::uint64_t index;
+			if(!number(index) || index > UINT32_MAX)
+				return nullptr;
+
+			// partial types are only ever created fresh
+			return findPartialType(data, static_cast<std::uint32_t>(index));
+		}
+
+		TypeHandle decode(){
+			if(p == end)
+				return nullptr;
+
+			switch(*p++){
+				case '?': return eat('?') ? data.infinityType : nullptr;
+				case '_': return partial();
+				case 't': return eat('?') ? data.typeType : nullptr;
+				case 'w': return eat('?') ? data.numberType : nullptr;
+				case 's': return string();
+				case 'o': return object();
+				case 'a': return array();
+				case 'u': return sum();
+				case 'p': return product();
+				case 'f': return function();
+
+				case 'c': case 'i': case 'r': case 'q': case 'z': case 'n': case 'b':
+					return sizedNumber(p[-1]);
+
+				default: return nullptr;
+			}
+		}
+	};
+
+	template<typename Data>
+	TypeHandle demangle(Data &data, std::string_view mangled){
+		Demangler<Data> demangler{data, mangled.data(), mangled.data() + mangled.size()};
+
+		auto type = demangler.type();
+
+		// the whole name must be one type
+		return demangler.p == demangler.end ? type : nullptr;
+	}
+}
+
+TypeHandle ilang::findDemangledType(const TypeData &data, std::string_view mangled) noexcept{
+	ILANG_TYPES_TRACE("findDemangledType");
+	ILANG_TYPES_RECORD_CALL(data);
+
+	TypeHandle res;
+
+	try{
+		res = demangle(data, mangled);
+	}
+	catch(const std::bad_alloc&){
+		// only long lists of inner types allocate, no such type can be found without memory for them
+		res = nullptr;
+	}
+
+	ILANG_TYPES_RECORD(TypeCall::findDemangledType, res, mangled);
+	return res;
+}
+
+TypeHandle ilang::getDemangledType(TypeData &data, std::string_view mangled){
+	ILANG_TYPES_TRACE("getDemangledType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = demangle(data, mangled);
+	ILANG_TYPES_RECORD(TypeCall::getDemangledType, res, mangled);
+	return res;
+}
@@ -0,0 +1,178 @@
+#include <mutex>
+#include <vector>
+
+#include "ilang/Type.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Bytes of a row of \ref TypeData::storage and every column of \ref TypeTable
+	constexpr std::size_t rowBytes =
+		sizeof(TypeHandle) + sizeof(TypeId) + sizeof(std::uint32_t) + sizeof(TypeKind) + sizeof(std::uint32_t) +
+		sizeof(std::uint64_t) + sizeof(Span<const TypeId>) + 2 * sizeof(InternedString);
+
+	//! Bytes of the pooled string \p str, including its length prefix and terminator
+	std::size_t internedBytes(InternedString str) noexcept{
+		return str.empty() ? 0 : sizeof(std::uint32_t) + str.size() + 1;
+	}
+
+	bool isCompoundKind(TypeKind kind) noexcept{
+		switch(kind){
+			case TypeKind::function:
+			case TypeKind::sum:
+			case TypeKind::product:
+			case TypeKind::tree:
+			case TypeKind::list:
+			case TypeKind::array:
+			case TypeKind::dynamicArray:
+			case TypeKind::staticArray:
+				return true;
+
+			default: return false;
+		}
+	}
+
+	//! Count every type of \p data into \p report, holding every lock types are created under
+	void walkTypeMemory(const TypeData &data, TypeMemoryReport &report){
+		for(std::size_t id = 0; id < data.storage.size(); id++){
+			auto type = data.storage[id];
+			if(!type)
+				continue;
+
+			auto &&kind = report.kinds[static_cast<std::size_t>(type->kind)];
+
+			++kind.numTypes;
+			kind.innerTypeBytes += sizeof(TypeHandle) * type->ancestors.size() + (sizeof(TypeHandle) + sizeof(TypeId)) * type->types.size();
+
+			// compound names are only read once rendered, other threads may be rendering them now
+			auto compound = isCompoundKind(type->kind);
+
+			if(!compound || type->strRendered.load(std::memory_order_acquire))
+				kind.nameBytes += internedBytes(type->str);
+
+			if(!compound || type->mangledRendered.load(std::memory_order_acquire))
+				kind.nameBytes += internedBytes(type->mangled);
+		}
+	}
+}
+
+TypeMemoryReport ilang::getTypeMemoryReport(const TypeData &data, bool walkTypes){
+	TypeMemoryReport report;
+
+	// every type is created under a shard or the maps mutex, so holding all of them stops new types
+	std::vector<std::unique_lock<std::mutex>> locks;
+
+	if(walkTypes && data.shards){
+		for(std::size_t i = 0; i < data.shards->numShards; i++)
+			locks.emplace_back(data.shards->shards[i].mutex);
+
+		locks.emplace_back(data.shards->mapsMutex);
+	}
+
+	auto sumCounters = [&report](const TypeMemoryCounters &memory){
+		for(std::size_t i = 0; i < numTypeKinds; i++){
+			auto &&counters = memory.kinds[i];
+			auto &&kind = report.kinds[i];
+
+			kind.numTypes += counters.numTypes.load(std::memory_order_relaxed);
+			kind.innerTypeBytes += counters.innerTypeBytes.load(std::memory_order_relaxed);
+			kind.nameBytes += counters.nameBytes.load(std::memory_order_relaxed);
+		}
+	};
+
+	if(walkTypes)
+		walkTypeMemory(data, report);
+	else{
+		sumCounters(*data.memory);
+
+		for(std::size_t i = 0; data.shards && i < data.shards->numShards; i++){
+			sumCounters(data.shards->shards[i].memory);
+			sumCounters(data.shards->nameShards[i].memory);
+		}
+	}
+
+	std::size_t usedBytes = 0, numCompoundTypes = 0;
+
+	for(std::size_t i = 0; i < numTypeKinds; i++){
+		auto &&kind = report.kinds[i];
+
+		kind.nodeBytes = sizeof(Type) * kind.numTypes;
+		kind.tableBytes = rowBytes * kind.numTypes;
+
+		usedBytes += kind.nodeBytes + kind.innerTypeBytes + kind.nameBytes;
+
+		if(isCompoundKind(static_cast<TypeKind>(i)))
+			numCompoundTypes += kind.numTypes;
+	}
+
+	// interning tables
+	std::size_t internerBytes = 0, slabBytes = 0;
+
+	if(!data.shards)
+		internerBytes = data.internedTypes.bytesAllocated();
+	else{
+		for(std::size_t i = 0; i < data.shards->numShards; i++){
+			auto &&shard = data.shards->shards[i];
+
+			std::unique_lock<std::mutex> lock;
+			if(!walkTypes)
+				lock = std::unique_lock<std::mutex>(shard.mutex);
+
+			internerBytes += shard.interner.bytesAllocated();
+			slabBytes += shard.arena.bytesReserved();
+		}
+	}
+
+	for(std::size_t i = 0; i < numTypeKinds && numCompoundTypes; i++)
+		if(isCompoundKind(static_cast<TypeKind>(i)))
+			report.kinds[i].internBytes = internerBytes * report.kinds[i].numTypes / numCompoundTypes;
+
+	// types not interned by structure
+	{
+		std::unique_lock<std::mutex> mapsLock;
+		if(data.shards && !walkTypes)
+			mapsLock = std::unique_lock<std::mutex>(data.shards->mapsMutex);
+
+		auto &&sizedNumbers = report.kinds[static_cast<std::size_t>(TypeKind::sizedNumber)];
+		auto &&strings = report.kinds[static_cast<std::size_t>(TypeKind::string)];
+		auto &&partials = report.kinds[static_cast<std::size_t>(TypeKind::partial)];
+
+		sizedNumbers.internBytes =
+			data.sizedBooleanTypes.bytesAllocated() + data.sizedNaturalTypes.bytesAllocated() +
+			data.sizedIntegerTypes.bytesAllocated() + data.sizedRationalTypes.bytesAllocated() +
+			data.sizedImaginaryTypes.bytesAllocated() + data.sizedRealTypes.bytesAllocated() +
+			data.sizedComplexTypes.bytesAllocated();
+
+		strings.internBytes = data.encodedStringTypes.bytesAllocated();
+		partials.internBytes = sizeof(TypeHandle) * data.partialTypes.size();
+
+		slabBytes += data.arena.bytesReserved();
+	}
+
+	// names
+	auto addNames = [&](const NameIndex &nameIndex, const NameIndex &mangledIndex, const StringPool &strings){
+		report.nameIndexBytes += nameIndex.bytesAllocated() + mangledIndex.bytesAllocated() + sizeof(StringPool::Slot) * strings.slots.capacity();
+		slabBytes += strings.arena.bytesReserved();
+	};
+
+	if(!data.shards)
+		addNames(data.nameIndex, data.mangledIndex, data.strings);
+	else{
+		for(std::size_t i = 0; i < data.shards->numShards; i++){
+			auto &&nameShard = data.shards->nameShards[i];
+			auto &&stringShard = data.shards->stringShards[i];
+
+			std::lock_guard<std::mutex> namesLock(nameShard.mutex);
+			std::lock_guard<std::mutex> stringsLock(stringShard.mutex);
+			addNames(nameShard.nameIndex, nameShard.mangledIndex, stringShard.strings);
+		}
+	}
+
+	report.unusedBytes = slabBytes > usedBytes ? slabBytes - usedBytes : 0;
+
+	report.totalBytes = report.nameIndexBytes + report.unusedBytes;
+	for(auto &&kind : report.kinds)
+		report.totalBytes += kind.totalBytes();
+
+	return report;
+}
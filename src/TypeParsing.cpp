@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "ilang/TypeParsing.hpp"
+#include "ilang/TypeTrace.hpp"
+
+#include "InnerTypes.hpp"
+#include "RecordCall.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Deepest nesting parsed, so malicious names can not exhaust the stack
+	constexpr std::size_t maxDepth = 256;
+
+	//! Named types of the prelude that are not aliases
+	struct RootName{
+		std::string_view name;
+		TypeHandle TypeData::*type;
+	};
+
+	constexpr RootName rootNames[] = {
+		{"Infinity", &TypeData::infinityType},
+		{"Partial", &TypeData::partialType},
+		{"Type", &TypeData::typeType},
+		{"Unit", &TypeData::unitType},
+		{"String", &TypeData::stringType},
+		{"Number", &TypeData::numberType},
+		{"Function", &TypeData::functionType},
+		{"Complex", &TypeData::complexType},
+		{"Imaginary", &TypeData::imaginaryType},
+		{"Real", &TypeData::realType},
+		{"Rational", &TypeData::rationalType},
+		{"Integer", &TypeData::integerType},
+		{"Natural", &TypeData::naturalType},
+		{"Boolean", &TypeData::booleanType},
+	};
+
+	bool isLetter(char c) noexcept{ return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+	bool isDigit(char c) noexcept{ return c >= '0' && c <= '9'; }
+
+	/**
+	 * \brief Recursive descent parser over a display name
+	 *
+	 * Finds types in a const \p Data and gets them otherwise.
+	 **/
+	template<typename Data>
+	struct Parser{
+		static constexpr bool creates = !std::is_const_v<Data>;
+
+		Data &data;
+		const char *p, *end;
+		std::size_t depth = 0;
+
+		void skipSpace() noexcept{
+			while(p != end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+				++p;
+		}
+
+		bool eat(std::string_view token) noexcept{
+			skipSpace();
+
+			if(static_cast<std::size_t>(end - p) < token.size() || std::string_view(p, token.size()) != token)
+				return false;
+
+			p += token.size();
+			return true;
+		}
+
+		std::string_view identifier() noexcept{
+			skipSpace();
+
+			auto start = p;
+			if(p != end && isLetter(*p))
+				for(++p; p != end && (isLetter(*p) || isDigit(*p)); ++p){}
+
+			return std::string_view(start, static_cast<std::size_t>(p - start));
+		}
+
+		//! Parse a number without leading zeros
+		bool number(std::uint64_t &n) noexcept{
+			skipSpace();
+
+			if(p == end || !isDigit(*p))
+				return false;
+
+			n = 0;
+
+			if(*p == '0'){
+				++p;
+				return p == end || !isDigit(*p);
+			}
+
+			for(; p != end && isDigit(*p); ++p){
+				auto digit = static_cast<std::uint64_t>(*p - '0');
+				if(n > (UINT64_MAX - digit) / 10)
+					return false;
+
+				n = n * 10 + digit;
+			}
+
+			return true;
+		}
+
+		//! An alias or a root name
+		TypeHandle namedType(std::string_view name) noexcept{
+			auto aliased = data.typeAliases.find(name);
+			if(aliased != data.typeAliases.end())
+				return aliased->second;
+
+			for(auto &&root : rootNames)
+				if(root.name == name)
+					return data.*(root.type);
+
+			return nullptr;
+		}
+
+		TypeHandle sizedNumber(TypeHandle family, std::uint32_t bits){
+		#define PARSE_NUMBER(T, t)\
+			if(family == data.t##Type){\
+				if constexpr(creates) return get##T##Type(data, bits);\
+				else return find##T##Type(data, bits);\
+			}
+
+			PARSE_NUMBER(Complex, complex)
+			PARSE_NUMBER(Imaginary, imaginary)
+			PARSE_NUMBER(Real, real)
+			PARSE_NUMBER(Rational, rational)
+			PARSE_NUMBER(Integer, integer)
+			PARSE_NUMBER(Natural, natural)
+			PARSE_NUMBER(Boolean, boolean)
+
+		#undef PARSE_NUMBER
+
+			return nullptr;
+		}
+
+		TypeHandle name(){
+			auto str = identifier();
+			if(str.empty())
+				return nullptr;
+
+			if(auto type = namedType(str))
+				return type;
+
+			if(str == "AsciiString" || str == "Utf8String"){
+				auto encoding = str[0] == 'A' ? StringEncoding::ascii : StringEncoding::utf8;
+
+				if constexpr(creates) return getStringType(data, encoding);
+				else return findStringType(data, encoding);
+			}
+
+			// a family or partial name followed by a number, e.g. Integer32, Int12 or Partial3
+			auto numDigits = static_cast<std::size_t>(std::find_if(str.rbegin(), str.rend(), [](char c){ return !isDigit(c); }) - str.rbegin());
+			if(numDigits == 0 || numDigits == str.size())
+				return nullptr;
+
+			auto prefix = str.substr(0, str.size() - numDigits);
+			auto digits = str.substr(prefix.size());
+			if(digits.size() > 1 && digits[0] == '0')
+				return nullptr;
+
+			std::uint64_t n = 0;
+			for(auto c : digits){
+				n = n * 10 + static_cast<std::uint64_t>(c - '0');
+				if(n > UINT32_MAX)
+					return nullptr;
+			}
+
+			// partial types are only ever created fresh
+			if(prefix == "Partial")
+				return findPartialType(data, static_cast<std::uint32_t>(n));
+
+			auto family = namedType(prefix);
+			if(!family || n == 0)
+				return nullptr;
+
+			return sizedNumber(family, static_cast<std::uint32_t>(n));
+		}
+
+		//! Tree, List, Array, DynamicArray or StaticArray after the '(' and keyword
+		TypeHandle object(std::string_view keyword){
+			auto inner = type();
+			if(!inner)
+				return nullptr;
+
+			if(keyword == "StaticArray"){
+				std::uint64_t n;
+				if(!number(n) || !eat(")"))
+					return nullptr;
+
+				if constexpr(creates) return getStaticArrayType(data, inner, static_cast<std::size_t>(n));
+				else return findStaticArrayType(data, inner, static_cast<std::size_t>(n));
+			}
+
+			if(!eat(")"))
+				return nullptr;
+
+		#define PARSE_OBJECT(T)\
+			if(keyword == #T){\
+				if constexpr(creates) return get##T##Type(data, inner);\
+				else return find##T##Type(data, inner);\
+			}
+
+			PARSE_OBJECT(Tree)
+			PARSE_OBJECT(List)
+			PARSE_OBJECT(Array)
+			PARSE_OBJECT(DynamicArray)
+
+		#undef PARSE_OBJECT
+
+			return nullptr;
+		}
+
+		TypeHandle primary(){
+			if(!eat("("))
+				return name();
+
+			auto start = p;
+			auto keyword = identifier();
+
+			if(
+				(keyword == "Tree" || keyword == "List" || keyword == "Array" || keyword == "DynamicArray" || keyword == "StaticArray") &&
+				p != end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+			)
+				return object(keyword);
+
+			// just grouping
+			p = start;
+
+			auto inner = type();
+			return inner && eat(")") ? inner : nullptr;
+		}
+
+		TypeHandle product(){
+			auto first = primary();
+			if(!first || !eat("*"))
+				return first;
+
+			InnerTypes types;
+			types.push(first);
+
+			do{
+				auto inner = primary();
+				if(!inner)
+					return nullptr;
+
+				types.push(inner);
+			} while(eat("*"));
+
+			if constexpr(creates) return getProductType(data, types.vector());
+			else return findCompoundType(data, TypeKey{TypeKind::product, types.data(), types.size()});
+		}
+
+		TypeHandle sum(){
+			auto first = product();
+			if(!first || !eat("|"))
+				return first;
+
+			InnerTypes types;
+			types.push(first);
+
+			do{
+				auto inner = product();
+				if(!inner)
+					return nullptr;
+
+				types.push(inner);
+			} while(eat("|"));
+
+			if constexpr(creates)
+				return getSumType(data, types.vector());
+			else{
+				// inner types are interned in id order
+				auto begin = types.data(), last = begin + types.size();
+				std::sort(begin, last, [](TypeHandle lhs, TypeHandle rhs){ return lhs->id < rhs->id; });
+				last = std::unique(begin, last);
+
+				return findCompoundType(data, TypeKey{TypeKind::sum, begin, static_cast<std::size_t>(last - begin)});
+			}
+		}
+
+		TypeHandle function(){
+			auto first = sum();
+			if(!first || !eat("->"))
+				return first;
+
+			InnerTypes params;
+			params.push(first);
+
+			do{
+				auto inner = sum();
+				if(!inner)
+					return nullptr;
+
+				params.push(inner);
+			} while(eat("->"));
+
+			auto result = params.back();
+			params.pop_back();
+
+			if constexpr(creates) return getFunctionType(data, params.vector(), result);
+			else return findCompoundType(data, TypeKey{TypeKind::function, params.data(), params.size(), result});
+		}
+
+		TypeHandle type(){
+			if(depth == maxDepth)
+				return nullptr;
+
+			++depth;
+			auto res = function();
+			--depth;
+			return res;
+		}
+	};
+
+	template<typename Data>
+	TypeHandle parse(Data &data, std::string_view str){
+		Parser<Data> parser{data, str.data(), str.data() + str.size()};
+
+		auto type = parser.type();
+		parser.skipSpace();
+
+		// the whole string must be one type
+		return parser.p == parser.end ? type : nullptr;
+	}
+}
+
+TypeHandle ilang::findParsedType(const TypeData &data, std::string_view str) noexcept{
+	ILANG_TYPES_TRACE("findParsedType");
+	ILANG_TYPES_RECORD_CALL(data);
+
+	TypeHandle res;
+
+	try{
+		res = parse(data, str);
+	}
+	catch(const std::bad_alloc&){
+		// only long lists of inner types allocate, no such type can be found without memory for them
+		res = nullptr;
+	}
+
+	ILANG_TYPES_RECORD(TypeCall::findParsedType, res, str);
+	return res;
+}
+
+TypeHandle ilang::getParsedType(TypeData &data, std::string_view str){
+	ILANG_TYPES_TRACE("getParsedType");
+	ILANG_TYPES_RECORD_CALL(data);
+	auto res = parse(data, str);
+	ILANG_TYPES_RECORD(TypeCall::getParsedType, res, str);
+	return res;
+}
@@ -0,0 +1,755 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+#include "ilang/TypeIO.hpp"
+#include "ilang/TypeMangling.hpp"
+#include "ilang/TypeParsing.hpp"
+#include "ilang/TypeRecording.hpp"
+
+#include "RecordCall.hpp"
+
+using namespace ilang;
+
+namespace {
+	constexpr char magic[4] = {'I', 'L', 'T', 'R'};
+
+	//! Longest string argument read, so a bogus size can not exhaust memory
+	constexpr std::uint64_t maxStringSize = 16 * 1024 * 1024;
+
+	struct CallInfo{
+		const char *name, *args;
+		char result;
+	};
+
+	constexpr CallInfo callInfos[] = {
+	#define CALL_INFO(name, args, result) {#name, args, result},
+		ILANG_TYPES_CALLS(CALL_INFO)
+	#undef CALL_INFO
+	};
+
+	static_assert(std::size(callInfos) == numTypeCalls);
+
+	[[noreturn]] void malformed(const char *what){
+		throw std::runtime_error(std::string("malformed type recording: ") + what);
+	}
+
+	void markRecorded(TypeRecorder &recorder, TypeHandle type){
+		if(type->id >= recorder.recorded.size())
+			recorder.recorded.resize(type->id + 1);
+
+		recorder.recorded[type->id] = true;
+	}
+
+	//! Record a \ref TypeCall::type recreating \p type after the types it is made of, unless a call already produced it
+	void recordType(TypeRecorder &recorder, TypeHandle type){
+		if(type->id < recorder.recorded.size() && recorder.recorded[type->id])
+			return;
+
+		// bases of records are prelude types, inner types are recorded first
+		for(auto inner : type->types)
+			recordType(recorder, inner);
+
+		beginCall(recorder, TypeCall::type);
+		writeTypeRecord(*recorder.writer, type);
+		finishCall(recorder, type);
+	}
+
+	//! Reader of the calls after the header of a recording
+	struct CallReader{
+		FileReader &reader;
+		TypeWorkload &workload;
+
+		//! Whether a call produced the type with each id
+		std::vector<bool> produced;
+
+		std::uint64_t number(){
+			auto n = reader.readVarint();
+			workload.args.push_back(n);
+			return n;
+		}
+
+		void type(){
+			auto id = reader.readVarint();
+			if(id >= produced.size() || !produced[static_cast<std::size_t>(id)])
+				malformed("reference to a type before a call produced it");
+
+			workload.args.push_back(id);
+		}
+
+		void types(){
+			// the count is not trusted for allocating, a bogus one runs into the end of the file instead
+			auto n = number();
+			for(std::uint64_t i = 0; i < n; i++)
+				type();
+		}
+
+		void string(){
+			auto n = reader.readVarint();
+			if(n > maxStringSize) malformed("string too long");
+
+			auto offset = workload.strings.size();
+			workload.strings.resize(offset + static_cast<std::size_t>(n));
+			reader.read(workload.strings.data() + offset, static_cast<std::size_t>(n));
+
+			workload.args.push_back(offset);
+			workload.args.push_back(n);
+		}
+
+		//! A \ref TypeKey: kind, inner types, result plus one or zero and parameter
+		void key(){
+			if(number() > static_cast<std::uint64_t>(TypeKind::staticArray)) malformed("unknown type kind");
+
+			types();
+
+			auto result = reader.readVarint();
+			if(result && (result - 1 >= produced.size() || !produced[static_cast<std::size_t>(result - 1)]))
+				malformed("reference to a type before a call produced it");
+
+			workload.args.push_back(result);
+			number();
+		}
+
+		//! A type record, see \ref writeTypeRecord
+		void record(){
+			auto kind = static_cast<TypeKind>(reader.readByte());
+			workload.args.push_back(static_cast<std::uint64_t>(kind));
+
+			switch(kind){
+				case TypeKind::sizedNumber:
+					type();
+					if(number() > UINT32_MAX) malformed("sized number too large");
+					break;
+
+				case TypeKind::string:
+					if(number() > static_cast<std::uint64_t>(StringEncoding::utf8)) malformed("unknown string encoding");
+					break;
+
+				case TypeKind::partial: break;
+
+				case TypeKind::tree:
+				case TypeKind::list:
+				case TypeKind::array:
+				case TypeKind::dynamicArray:
+					type();
+					break;
+
+				case TypeKind::staticArray:
+					type();
+					number();
+					break;
+
+				case TypeKind::sum:
+				case TypeKind::product:
+				case TypeKind::function:{
+					auto first = workload.args.size();
+					types();
+
+					auto n = workload.args[first];
+					if((kind == TypeKind::product && n < 2) || (kind == TypeKind::function && n < 1))
+						malformed("compound type with too few inner types");
+
+					break;
+				}
+
+				default: malformed("unknown type kind");
+			}
+		}
+
+		void call(){
+			auto code = reader.readByte();
+			if(code >= numTypeCalls) malformed("unknown call");
+
+			auto call = static_cast<TypeCall>(code);
+			TypeWorkload::Call res{call, workload.args.size(), 0};
+
+			for(auto arg = callInfos[code].args; *arg; ++arg){
+				switch(*arg){
+					case 't': type(); break;
+					case 'v': types(); break;
+					case 's': string(); break;
+					case 'k': key(); break;
+					case 'r': record(); break;
+					default: number(); break;
+				}
+			}
+
+			// numbers that are only valid in a range
+			switch(call){
+				case TypeCall::findStringType:
+				case TypeCall::getStringType:
+					if(workload.args[res.firstArg] > static_cast<std::uint64_t>(StringEncoding::utf8) + 1) malformed("unknown string encoding");
+					break;
+
+				case TypeCall::findPartialType:
+					if(workload.args[res.firstArg] > std::uint64_t(UINT32_MAX) + 1) malformed("partial type index too large");
+					break;
+
+				case TypeCall::findComplexType: case TypeCall::findImaginaryType: case TypeCall::findRealType: case TypeCall::findRationalType:
+				case TypeCall::findIntegerType: case TypeCall::findNaturalType: case TypeCall::findBooleanType:
+				case TypeCall::getComplexType: case TypeCall::getImaginaryType: case TypeCall::getRealType: case TypeCall::getRationalType:
+				case TypeCall::getIntegerType: case TypeCall::getNaturalType: case TypeCall::getBooleanType:
+					if(workload.args[res.firstArg] > UINT32_MAX) malformed("sized number too large");
+					break;
+
+				default: break;
+			}
+
+			res.result = reader.readVarint();
+
+			if(callInfos[code].result == 't' && res.result){
+				auto id = res.result - 1;
+				if(id >= invalidTypeId) malformed("invalid type id");
+
+				if(id >= produced.size())
+					produced.resize(static_cast<std::size_t>(id + 1));
+
+				produced[static_cast<std::size_t>(id)] = true;
+			}
+
+			workload.calls.push_back(res);
+		}
+	};
+
+	struct CallArgs;
+
+	//! Replays calls onto a data, mapping recorded ids to the types the replayed calls returned
+	struct Replayer{
+		const TypeWorkload &workload;
+		TypeData &data;
+		std::unique_ptr<std::atomic<TypeHandle>[]> types;
+		std::atomic<std::uint64_t> numMismatches{0};
+
+		//! Set when a thread failed, so threads waiting for its types give up
+		std::atomic<bool> failed{false};
+
+		TypeHandle type(std::uint64_t id) const{
+			auto &&slot = types[static_cast<std::size_t>(id)];
+			auto type = slot.load(std::memory_order_acquire);
+
+			// produced by an earlier call another thread is still replaying
+			while(!type){
+				if(failed.load(std::memory_order_relaxed))
+					throw std::runtime_error("type replay aborted by another thread");
+
+				std::this_thread::yield();
+				type = slot.load(std::memory_order_acquire);
+			}
+
+			return type;
+		}
+
+		TypeHandle recreate(CallArgs &args);
+		void replay(std::size_t index);
+	};
+
+	//! Cursor over the decoded arguments of a call
+	struct CallArgs{
+		const Replayer &replayer;
+		const std::uint64_t *p;
+
+		std::uint64_t number() noexcept{ return *p++; }
+		std::uint32_t numBits() noexcept{ return static_cast<std::uint32_t>(number()); }
+		TypeHandle type(){ return replayer.type(number()); }
+
+		std::vector<TypeHandle> types(){
+			auto n = number();
+
+			std::vector<TypeHandle> res;
+			res.reserve(static_cast<std::size_t>(n));
+
+			for(std::uint64_t i = 0; i < n; i++)
+				res.emplace_back(type());
+
+			return res;
+		}
+
+		std::string_view string() noexcept{
+			auto offset = number();
+			auto size = number();
+			return std::string_view(replayer.workload.strings).substr(static_cast<std::size_t>(offset), static_cast<std::size_t>(size));
+		}
+
+		std::optional<std::uint32_t> index() noexcept{
+			auto n = number();
+			return n ? std::optional<std::uint32_t>(static_cast<std::uint32_t>(n - 1)) : std::nullopt;
+		}
+
+		std::optional<StringEncoding> encoding() noexcept{
+			auto n = number();
+			return n ? std::optional<StringEncoding>(static_cast<StringEncoding>(n - 1)) : std::nullopt;
+		}
+	};
+
+	TypeHandle Replayer::recreate(CallArgs &args){
+		switch(static_cast<TypeKind>(args.number())){
+			case TypeKind::sizedNumber:{
+				auto base = args.type();
+				auto numBits = args.numBits();
+
+			#define REPLAY_SIZED_NUMBER(T, t)\
+				if(base == data.t##Type) return get##T##Type(data, numBits);
+
+				REPLAY_SIZED_NUMBER(Boolean, boolean)
+				REPLAY_SIZED_NUMBER(Natural, natural)
+				REPLAY_SIZED_NUMBER(Integer, integer)
+				REPLAY_SIZED_NUMBER(Rational, rational)
+				REPLAY_SIZED_NUMBER(Real, real)
+				REPLAY_SIZED_NUMBER(Imaginary, imaginary)
+				REPLAY_SIZED_NUMBER(Complex, complex)
+
+			#undef REPLAY_SIZED_NUMBER
+
+				return nullptr;
+			}
+
+			case TypeKind::string: return getStringType(data, static_cast<StringEncoding>(args.number()));
+			case TypeKind::partial: return getPartialType(data);
+
+			case TypeKind::tree: return getTreeType(data, args.type());
+			case TypeKind::list: return getListType(data, args.type());
+			case TypeKind::array: return getArrayType(data, args.type());
+			case TypeKind::dynamicArray: return getDynamicArrayType(data, args.type());
+
+			case TypeKind::staticArray:{
+				auto inner = args.type();
+				return getStaticArrayType(data, inner, static_cast<std::size_t>(args.number()));
+			}
+
+			case TypeKind::sum: return getSumType(data, args.types());
+			case TypeKind::product: return getProductType(data, args.types());
+
+			case TypeKind::function:{
+				auto types = args.types();
+				auto result = types.back();
+				types.pop_back();
+				return getFunctionType(data, std::move(types), result);
+			}
+
+			default: return nullptr;
+		}
+	}
+
+	void Replayer::replay(std::size_t index){
+		auto &&call = workload.calls[index];
+		CallArgs args{*this, workload.args.data() + call.firstArg};
+
+		TypeHandle type = nullptr;
+		bool truth = false;
+
+		switch(call.call){
+			case TypeCall::type: type = recreate(args); break;
+
+			case TypeCall::alias:{
+				auto name = args.string();
+				data.typeAliases[std::string(name)] = args.type();
+				break;
+			}
+
+			case TypeCall::getTypeName: getTypeName(data, args.type()); break;
+			case TypeCall::getMangledName: getMangledName(data, args.type()); break;
+
+			case TypeCall::hasBaseType:{
+				auto type0 = args.type();
+				truth = hasBaseType(data, type0->id, args.type()->id);
+				break;
+			}
+
+			case TypeCall::findTypeByString: type = findTypeByString(data, args.string()); break;
+			case TypeCall::findTypeByMangled: type = findTypeByMangled(data, args.string()); break;
+
+			case TypeCall::findCommonType:{
+				auto type0 = args.type();
+				type = data.storage[findCommonType(data, type0->id, args.type()->id)];
+				break;
+			}
+
+			case TypeCall::findPartialType: type = findPartialType(data, args.index()); break;
+			case TypeCall::findStringType: type = findStringType(data, args.encoding()); break;
+			case TypeCall::getStringType: type = getStringType(data, args.encoding()); break;
+			case TypeCall::getPartialType: type = getPartialType(data); break;
+
+		#define REPLAY_INNER(T)\
+			case TypeCall::find##T##Type: type = find##T##Type(data, args.type()); break;\
+			case TypeCall::get##T##Type: type = get##T##Type(data, args.type()); break;
+
+			REPLAY_INNER(Tree)
+			REPLAY_INNER(List)
+			REPLAY_INNER(Array)
+			REPLAY_INNER(DynamicArray)
+
+		#undef REPLAY_INNER
+
+			case TypeCall::findStaticArrayType:{
+				auto inner = args.type();
+				type = findStaticArrayType(data, inner, static_cast<std::size_t>(args.number()));
+				break;
+			}
+
+			case TypeCall::getStaticArrayType:{
+				auto inner = args.type();
+				type = getStaticArrayType(data, inner, static_cast<std::size_t>(args.number()));
+				break;
+			}
+
+		#define REPLAY_NUMBER(T)\
+			case TypeCall::find##T##Type: type = find##T##Type(data, args.numBits()); break;\
+			case TypeCall::get##T##Type: type = get##T##Type(data, args.numBits()); break;
+
+			REPLAY_NUMBER(Complex)
+			REPLAY_NUMBER(Imaginary)
+			REPLAY_NUMBER(Real)
+			REPLAY_NUMBER(Rational)
+			REPLAY_NUMBER(Integer)
+			REPLAY_NUMBER(Natural)
+			REPLAY_NUMBER(Boolean)
+
+		#undef REPLAY_NUMBER
+
+			case TypeCall::findSumType: type = findSumType(data, args.types()); break;
+			case TypeCall::findProductType: type = findProductType(data, args.types()); break;
+			case TypeCall::getSumType: type = getSumType(data, args.types()); break;
+			case TypeCall::getProductType: type = getProductType(data, args.types()); break;
+
+			case TypeCall::findFunctionType:{
+				auto params = args.types();
+				type = findFunctionType(data, params, args.type());
+				break;
+			}
+
+			case TypeCall::getFunctionType:{
+				auto params = args.types();
+				auto result = args.type();
+				type = getFunctionType(data, std::move(params), result);
+				break;
+			}
+
+			case TypeCall::findCompoundType:{
+				auto kind = static_cast<TypeKind>(args.number());
+				auto inner = args.types();
+				auto result = args.number();
+				auto resultType = result ? this->type(result - 1) : nullptr;
+
+				type = findCompoundType(data, TypeKey{kind, inner.data(), inner.size(), resultType, args.number()});
+				break;
+			}
+
+			case TypeCall::findDemangledType: type = findDemangledType(data, args.string()); break;
+			case TypeCall::getDemangledType: type = getDemangledType(data, args.string()); break;
+			case TypeCall::findParsedType: type = findParsedType(data, args.string()); break;
+			case TypeCall::getParsedType: type = getParsedType(data, args.string()); break;
+		}
+
+		switch(callInfos[static_cast<std::size_t>(call.call)].result){
+			case 't':
+				if(call.result){
+					if(!type){
+						// later calls still need a type to continue with
+						numMismatches.fetch_add(1, std::memory_order_relaxed);
+						type = data.infinityType;
+					}
+
+					// prelude types are the same in every data
+					if(call.result - 1 >= workload.numPreludeTypes)
+						types[static_cast<std::size_t>(call.result - 1)].store(type, std::memory_order_release);
+				}
+				else if(type)
+					numMismatches.fetch_add(1, std::memory_order_relaxed);
+
+				break;
+
+			case 'b':
+				if(truth != (call.result != 0))
+					numMismatches.fetch_add(1, std::memory_order_relaxed);
+
+				break;
+
+			default: break;
+		}
+	}
+}
+
+TypeRecorder::TypeRecorder(int fd)
+	: writer(std::make_unique<FileWriter>(fd)){}
+
+TypeRecorder::~TypeRecorder() = default;
+
+const char *ilang::getTypeCallName(TypeCall call) noexcept{
+	auto index = static_cast<std::size_t>(call);
+	return index < numTypeCalls ? callInfos[index].name : "unknown";
+}
+
+void ilang::prepareCallArg(TypeRecorder &recorder, TypeHandle type){
+	recordType(recorder, type);
+}
+
+void ilang::prepareCallArg(TypeRecorder &recorder, const std::vector<TypeHandle> &types){
+	for(auto type : types)
+		recordType(recorder, type);
+}
+
+void ilang::prepareCallArg(TypeRecorder &recorder, const TypeKey &key){
+	for(std::size_t i = 0; i < key.numTypes; i++)
+		recordType(recorder, key.types[i]);
+
+	if(key.result)
+		recordType(recorder, key.result);
+}
+
+void ilang::beginCall(TypeRecorder &recorder, TypeCall call){
+	recorder.writer->writeByte(static_cast<std::uint8_t>(call));
+	++recorder.numCalls;
+}
+
+void ilang::writeCallArg(TypeRecorder &recorder, TypeHandle type){
+	recorder.writer->writeVarint(type->id);
+}
+
+void ilang::writeCallArg(TypeRecorder &recorder, const std::vector<TypeHandle> &types){
+	recorder.writer->writeVarint(types.size());
+	for(auto type : types)
+		recorder.writer->writeVarint(type->id);
+}
+
+void ilang::writeCallArg(TypeRecorder &recorder, const TypeKey &key){
+	auto &&writer = *recorder.writer;
+
+	writer.writeVarint(static_cast<std::uint64_t>(key.kind));
+	writer.writeVarint(key.numTypes);
+
+	for(std::size_t i = 0; i < key.numTypes; i++)
+		writer.writeVarint(key.types[i]->id);
+
+	writer.writeVarint(key.result ? key.result->id + std::uint64_t(1) : 0);
+	writer.writeVarint(key.param);
+}
+
+void ilang::writeCallArg(TypeRecorder &recorder, std::uint64_t n){
+	recorder.writer->writeVarint(n);
+}
+
+void ilang::writeCallArg(TypeRecorder &recorder, std::optional<std::uint32_t> n){
+	recorder.writer->writeVarint(n ? *n + std::uint64_t(1) : 0);
+}
+
+void ilang::writeCallArg(TypeRecorder &recorder, std::optional<StringEncoding> encoding){
+	recorder.writer->writeVarint(encoding ? static_cast<std::uint64_t>(*encoding) + 1 : 0);
+}
+
+void ilang::writeCallArg(TypeRecorder &recorder, std::string_view str){
+	recorder.writer->writeVarint(str.size());
+	recorder.writer->write(str.data(), str.size());
+}
+
+void ilang::finishCall(TypeRecorder &recorder, TypeHandle result){
+	recorder.writer->writeVarint(result ? result->id + std::uint64_t(1) : 0);
+
+	if(result)
+		markRecorded(recorder, result);
+}
+
+void ilang::finishCall(TypeRecorder &recorder, bool result){
+	recorder.writer->writeVarint(result ? 1 : 0);
+}
+
+void ilang::startTypeRecording(TypeData &data, int fd){
+#ifdef ILANG_TYPES_RECORDING
+	if(data.recorder)
+		throw std::runtime_error("type recording already started");
+
+	auto recorder = std::make_unique<TypeRecorder>(fd);
+	recorder->recorded.assign(data.numPreludeTypes, true);
+
+	auto &&writer = *recorder->writer;
+	auto numTypes = data.storage.size();
+
+	writer.write(magic, sizeof(magic));
+	writer.writeVarint(typeRecordingFormatVersion);
+	writer.writeVarint(data.numPreludeTypes);
+	writer.writeVarint(hashPrelude(data));
+	writer.writeVarint(numTypes - data.numPreludeTypes + data.typeAliases.size());
+
+	// inner types have lower ids, so every existing type is one call
+	for(auto id = data.numPreludeTypes; id < numTypes; id++)
+		recordType(*recorder, data.storage[id]);
+
+	for(auto &&alias : data.typeAliases){
+		beginCall(*recorder, TypeCall::alias);
+		writeCallArg(*recorder, std::string_view(alias.first));
+		writeCallArg(*recorder, alias.second);
+		writer.writeVarint(0);
+	}
+
+	writer.flush();
+	data.recorder = std::move(recorder);
+#else
+	(void)data;
+	(void)fd;
+	throw std::runtime_error("type recording is not compiled in, configure with ILANG_TYPES_ENABLE_RECORDING");
+#endif
+}
+
+std::uint64_t ilang::stopTypeRecording(TypeData &data){
+#ifdef ILANG_TYPES_RECORDING
+	if(!data.recorder)
+		return 0;
+
+	auto recorder = std::move(data.recorder);
+
+	if(!recorder->error){
+		try{
+			recorder->writer->flush();
+		}
+		catch(const std::system_error &err){
+			recorder->error = err.code();
+		}
+	}
+
+	if(recorder->error)
+		throw std::system_error(recorder->error, "writing type recording");
+
+	return recorder->numCalls;
+#else
+	(void)data;
+	return 0;
+#endif
+}
+
+TypeWorkload ilang::readTypeWorkload(int fd){
+	FileReader reader(fd);
+
+	char fileMagic[sizeof(magic)];
+	reader.read(fileMagic, sizeof(fileMagic));
+	if(!std::equal(std::begin(magic), std::end(magic), fileMagic))
+		malformed("not a type recording");
+
+	if(reader.readVarint() != typeRecordingFormatVersion)
+		throw std::runtime_error("type recording of another format version");
+
+	TypeWorkload workload;
+	workload.numPreludeTypes = static_cast<std::size_t>(reader.readVarint());
+	workload.preludeHash = reader.readVarint();
+	workload.numSetupCalls = static_cast<std::size_t>(reader.readVarint());
+
+	if(workload.numPreludeTypes > invalidTypeId)
+		malformed("invalid number of prelude types");
+
+	CallReader calls{reader, workload, std::vector<bool>(workload.numPreludeTypes, true)};
+
+	while(!reader.atEnd()){
+		auto numArgs = workload.args.size();
+		auto numStrings = workload.strings.size();
+
+		try{
+			calls.call();
+		}
+		catch(const std::system_error&){
+			throw;
+		}
+		catch(const std::runtime_error&){
+			// only the last call may be incomplete, after a crash while it was recorded
+			if(!reader.atEnd())
+				throw;
+
+			workload.args.resize(numArgs);
+			workload.strings.resize(numStrings);
+			break;
+		}
+	}
+
+	if(workload.numSetupCalls > workload.calls.size())
+		malformed("recording ends in its setup");
+
+	workload.numTypeIds = calls.produced.size();
+	return workload;
+}
+
+TypeReplayResult ilang::replayTypeWorkload(const TypeWorkload &workload, TypeData &data, const TypeReplayOptions &options){
+	if(workload.numPreludeTypes != data.numPreludeTypes || workload.preludeHash != hashPrelude(data))
+		throw std::runtime_error("type recording of another prelude");
+
+	if(options.numThreads == 0 || options.callsPerChunk == 0)
+		throw std::runtime_error("replay needs a thread and a call per chunk");
+
+	if(options.numThreads > 1 && !data.shards)
+		throw std::runtime_error("replay on several threads needs concurrent type data");
+
+	Replayer replayer{workload, data, std::make_unique<std::atomic<TypeHandle>[]>(std::max(workload.numTypeIds, workload.numPreludeTypes))};
+
+	for(std::size_t id = 0; id < workload.numPreludeTypes; id++)
+		replayer.types[id].store(data.storage[id], std::memory_order_relaxed);
+
+	auto numCalls = workload.calls.size();
+	auto numSetupCalls = workload.numSetupCalls;
+
+	auto t0 = std::chrono::steady_clock::now();
+
+	for(std::size_t i = 0; i < numSetupCalls; i++)
+		replayer.replay(i);
+
+	auto t1 = std::chrono::steady_clock::now();
+
+	if(options.numThreads == 1){
+		for(auto i = numSetupCalls; i < numCalls; i++)
+			replayer.replay(i);
+	}
+	else{
+		std::vector<std::thread> threads;
+		std::vector<std::exception_ptr> errors(options.numThreads);
+
+		// a call only waits for earlier ones, so the earliest call not yet replayed can always go ahead
+		auto replayChunks = [&](std::size_t t){
+			try{
+				for(auto chunk = t; ; chunk += options.numThreads){
+					auto first = numSetupCalls + chunk * options.callsPerChunk;
+					if(first >= numCalls)
+						break;
+
+					auto last = std::min(numCalls, first + options.callsPerChunk);
+					for(auto i = first; i < last; i++)
+						replayer.replay(i);
+				}
+			}
+			catch(...){
+				errors[t] = std::current_exception();
+				replayer.failed.store(true, std::memory_order_relaxed);
+			}
+		};
+
+		auto joinAll = [&threads]{
+			for(auto &&thread : threads)
+				thread.join();
+		};
+
+		try{
+			threads.reserve(options.numThreads);
+
+			for(std::size_t t = 0; t < options.numThreads; t++)
+				threads.emplace_back(replayChunks, t);
+		}
+		catch(...){
+			// the chunks of a thread that did not start are never replayed, so the others must give up waiting for them
+			replayer.failed.store(true, std::memory_order_relaxed);
+			joinAll();
+			throw;
+		}
+
+		joinAll();
+
+		for(auto &&error : errors)
+			if(error)
+				std::rethrow_exception(error);
+	}
+
+	auto t2 = std::chrono::steady_clock::now();
+
+	TypeReplayResult result;
+	result.numCalls = numCalls - numSetupCalls;
+	result.numMismatches = replayer.numMismatches.load(std::memory_order_relaxed);
+	result.setupTime = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0);
+	result.time = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1);
+	return result;
+}
@@ -0,0 +1,61 @@
+#include <mutex>
+
+#include "ilang/Type.hpp"
+
+using namespace ilang;
+
+#ifdef ILANG_TYPES_STATS
+BaseTypeCounters ilang::baseTypeCounters;
+#endif
+
+namespace {
+	//! Bytes allocated by \p memory, which is guarded by \p mutex
+	template<typename Memory>
+	std::size_t bytesAllocated(const Memory &memory, std::mutex &mutex){
+		std::lock_guard<std::mutex> lock(mutex);
+		return memory.bytesAllocated();
+	}
+
+#ifdef ILANG_TYPES_STATS
+	void copyLookup(TypeStats::Lookup &stats, const TypeCounters::Lookup &counters) noexcept{
+		stats.calls = counters.calls.load(std::memory_order_relaxed);
+		stats.hits = counters.hits.load(std::memory_order_relaxed);
+		stats.nanoseconds = counters.nanoseconds.load(std::memory_order_relaxed);
+	}
+#endif
+}
+
+TypeStats ilang::getTypeStats(const TypeData &data){
+	TypeStats stats;
+
+#ifdef ILANG_TYPES_STATS
+	stats.enabled = true;
+
+	for(std::size_t i = 0; i < numTypeKinds; i++){
+		auto &&counters = data.counters->kinds[i];
+		stats.kinds[i].hits = counters.hits.load(std::memory_order_relaxed);
+		stats.kinds[i].misses = counters.misses.load(std::memory_order_relaxed);
+		stats.kinds[i].creations = counters.creations.load(std::memory_order_relaxed);
+	}
+
+	copyLookup(stats.stringLookups, data.counters->stringLookups);
+	copyLookup(stats.mangledLookups, data.counters->mangledLookups);
+
+	stats.baseTypeChecks = baseTypeCounters.checks.load(std::memory_order_relaxed);
+	stats.baseTypeSteps = baseTypeCounters.steps.load(std::memory_order_relaxed);
+#endif
+
+	if(!data.shards)
+		stats.bytesAllocated = data.arena.bytesAllocated() + data.strings.bytesAllocated();
+	else{
+		stats.bytesAllocated = bytesAllocated(data.arena, data.shards->mapsMutex);
+
+		for(std::size_t i = 0; i < data.shards->numShards; i++){
+			auto &&shard = data.shards->shards[i];
+			auto &&stringShard = data.shards->stringShards[i];
+			stats.bytesAllocated += bytesAllocated(shard.arena, shard.mutex) + bytesAllocated(stringShard.strings, stringShard.mutex);
+		}
+	}
+
+	return stats;
+}
@@ -0,0 +1,29 @@
+#include <algorithm>
+
+#include "ilang/Type.hpp"
+
+using namespace ilang;
+
+void TypeTable::store(TypeHandle type, TypeArena &arena){
+	auto id = type->id;
+
+	bases.store(id, type->base->id);
+	depths.store(id, static_cast<std::uint32_t>(type->ancestors.size()));
+	kinds.store(id, type->kind);
+	flags.store(id, type->flags);
+	params.store(id, type->param);
+
+	Span<const TypeId> childIds;
+
+	if(!type->types.empty()){
+		auto n = type->types.size();
+		auto ptr = static_cast<TypeId*>(arena.allocate(sizeof(TypeId) * n, alignof(TypeId)));
+		std::transform(begin(type->types), end(type->types), ptr, [](TypeHandle inner){ return inner->id; });
+		childIds = {ptr, n};
+	}
+
+	children.store(id, childIds);
+
+	names.store(id, type->str);
+	mangledNames.store(id, type->mangled);
+}
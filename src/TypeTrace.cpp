@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+#include "ilang/TypeTrace.hpp"
+
+using namespace ilang;
+
+std::atomic<bool> ilang::typeTraceActive{false};
+
+namespace {
+	//! A finished operation; fields are atomic so traces can be written while threads record
+	struct Event{
+		std::atomic<const char*> name{nullptr};
+		std::atomic<std::uint64_t> start{0}, duration{0};
+	};
+
+	//! Events of one thread, overwritten oldest first
+	struct Ring{
+		Ring(std::size_t n, std::uint32_t tid_): events(new Event[n]), capacity(n), tid(tid_){}
+
+		std::unique_ptr<Event[]> events;
+		std::size_t capacity;
+		std::uint32_t tid;
+
+		//! Number of events recorded in the trace, only written by the owning thread
+		std::atomic<std::uint64_t> head{0};
+
+		//! Trace the events belong to
+		std::atomic<std::uint64_t> generation{0};
+
+		//! Next ring given back by a thread that exited, guarded by \ref Tracer::mutex
+		Ring *nextFree = nullptr;
+	};
+
+	//! Gives the ring of a thread back to the tracer once the thread exits
+	struct RingOwner{
+		RingOwner() = default;
+		~RingOwner();
+
+		RingOwner(const RingOwner&) = delete;
+		RingOwner &operator=(const RingOwner&) = delete;
+
+		Ring *ring = nullptr;
+	};
+
+	struct Tracer{
+		//! Guards \ref rings, \ref freeRings and \ref options
+		std::mutex mutex;
+
+		//! Every ring ever created, a ring is only owned by one thread at a time so it can keep its pointer
+		std::vector<std::unique_ptr<Ring>> rings;
+
+		//! Rings of threads that exited, linked by \ref Ring::nextFree and reused before creating another
+		Ring *freeRings = nullptr;
+
+		TypeTraceOptions options;
+
+		std::atomic<std::int64_t> slowThreshold{0};
+		std::atomic<std::FILE*> slowLog{nullptr};
+
+		//! Incremented by every \ref startTypeTrace
+		std::atomic<std::uint64_t> generation{0};
+
+		//! Start of the current trace
+		std::atomic<std::int64_t> epoch{0};
+	};
+
+	Tracer &tracer(){
+		static Tracer instance;
+		return instance;
+	}
+
+	thread_local Ring *threadRing = nullptr;
+	thread_local RingOwner ringOwner;
+
+	RingOwner::~RingOwner(){
+		if(!ring)
+			return;
+
+		auto &&t = tracer();
+
+		try{
+			std::lock_guard<std::mutex> lock(t.mutex);
+			ring->nextFree = t.freeRings;
+			t.freeRings = ring;
+		}
+		catch(...){
+			// the ring is only kept out of reuse
+		}
+	}
+
+	std::int64_t steadyNanoseconds() noexcept{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	Ring *registerRing() noexcept{
+		auto &&t = tracer();
+
+		try{
+			std::lock_guard<std::mutex> lock(t.mutex);
+
+			auto capacity = std::max<std::size_t>(1, t.options.eventsPerThread);
+			auto ring = t.freeRings;
+
+			if(ring){
+				// the ring keeps the events of the thread that exited, the new thread continues its track
+				if(ring->capacity != capacity){
+					ring->events.reset(new Event[capacity]);
+					ring->capacity = capacity;
+					ring->head.store(0, std::memory_order_relaxed);
+				}
+
+				t.freeRings = ring->nextFree;
+				ring->nextFree = nullptr;
+			}
+			else{
+				t.rings.emplace_back(std::make_unique<Ring>(capacity, static_cast<std::uint32_t>(t.rings.size())));
+				ring = t.rings.back().get();
+			}
+
+			ringOwner.ring = ring;
+			return threadRing = ring;
+		}
+		catch(...){
+			// tracing is best effort, the operation itself must not fail
+			return nullptr;
+		}
+	}
+}
+
+std::uint64_t ilang::typeTraceClock() noexcept{
+	auto now = steadyNanoseconds() - tracer().epoch.load(std::memory_order_relaxed);
+	return now > 0 ? static_cast<std::uint64_t>(now) : 0;
+}
+
+void ilang::recordTypeTraceEvent(const char *name, std::uint64_t start) noexcept{
+	auto end = typeTraceClock();
+	auto &&t = tracer();
+
+	// started before the trace was restarted
+	if(end < start)
+		return;
+
+	auto ring = threadRing ? threadRing : registerRing();
+	if(!ring)
+		return;
+
+	auto generation = t.generation.load(std::memory_order_acquire);
+	if(ring->generation.load(std::memory_order_relaxed) != generation){
+		ring->head.store(0, std::memory_order_relaxed);
+		ring->generation.store(generation, std::memory_order_release);
+	}
+
+	auto i = ring->head.load(std::memory_order_relaxed);
+	auto &&event = ring->events[i % ring->capacity];
+
+	event.name.store(name, std::memory_order_relaxed);
+	event.start.store(start, std::memory_order_relaxed);
+	event.duration.store(end - start, std::memory_order_relaxed);
+	ring->head.store(i + 1, std::memory_order_release);
+
+	auto threshold = t.slowThreshold.load(std::memory_order_relaxed);
+	if(threshold > 0 && end - start >= static_cast<std::uint64_t>(threshold)){
+		if(auto log = t.slowLog.load(std::memory_order_relaxed))
+			std::fprintf(log, "ilang-types: slow %s took %.3f us at %.3f ms\n", name, (end - start) / 1e3, start / 1e6);
+	}
+}
+
+void ilang::startTypeTrace(const TypeTraceOptions &options){
+	auto &&t = tracer();
+	std::lock_guard<std::mutex> lock(t.mutex);
+
+	t.options = options;
+	t.slowThreshold.store(options.slowThreshold.count(), std::memory_order_relaxed);
+	t.slowLog.store(options.slowLog, std::memory_order_relaxed);
+	t.epoch.store(steadyNanoseconds(), std::memory_order_relaxed);
+	t.generation.fetch_add(1, std::memory_order_release);
+
+	typeTraceActive.store(true, std::memory_order_relaxed);
+}
+
+void ilang::stopTypeTrace() noexcept{
+	typeTraceActive.store(false, std::memory_order_relaxed);
+}
+
+std::size_t ilang::writeTypeTrace(const char *path){
+	struct Copied{
+		const char *name;
+		std::uint64_t start, duration;
+	};
+
+	auto &&t = tracer();
+	std::lock_guard<std::mutex> lock(t.mutex);
+
+	auto file = std::fopen(path, "w");
+	if(!file)
+		throw std::system_error(errno, std::generic_category(), "opening type trace");
+
+	std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+	auto generation = t.generation.load(std::memory_order_acquire);
+	auto pid = static_cast<int>(::getpid());
+	std::size_t numWritten = 0;
+	std::vector<Copied> events;
+
+	for(auto &&ring : t.rings){
+		if(ring->generation.load(std::memory_order_acquire) != generation)
+			continue;
+
+		auto capacity = ring->capacity;
+		auto head = ring->head.load(std::memory_order_acquire);
+		auto first = head > capacity ? head - capacity : 0;
+
+		events.clear();
+		for(auto i = first; i < head; i++){
+			auto &&event = ring->events[i % capacity];
+			events.push_back({
+				event.name.load(std::memory_order_relaxed),
+				event.start.load(std::memory_order_relaxed),
+				event.duration.load(std::memory_order_relaxed)
+			});
+		}
+
+		// leave out events the thread may have overwritten, including the one it may be writing
+		auto newHead = ring->head.load(std::memory_order_acquire);
+		auto valid = newHead + 1 > capacity ? newHead + 1 - capacity : 0;
+		auto skip = valid > first ? std::min<std::size_t>(valid - first, events.size()) : 0;
+
+		for(auto it = events.begin() + static_cast<std::ptrdiff_t>(skip); it != events.end(); ++it){
+			std::fprintf(
+				file, "%s\n{\"name\":\"%s\",\"cat\":\"ilang-types\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				numWritten ? "," : "", it->name, pid, ring->tid, it->start / 1e3, it->duration / 1e3
+			);
+
+			++numWritten;
+		}
+	}
+
+	std::fprintf(file, "\n]}\n");
+
+	auto failed = std::ferror(file);
+	if(std::fclose(file) != 0 || failed)
+		throw std::system_error(errno ? errno : EIO, std::generic_category(), "writing type trace");
+
+	return numWritten;
+}
@@ -0,0 +1,41 @@
+#ifndef ILANG_TESTS_CHECK_HPP
+#define ILANG_TESTS_CHECK_HPP 1
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+
+/**
+ * \brief Report a failed check of \p cond and carry on with the test
+ *
+ * Test executables return \ref ilang::tests::result from main, so ctest fails if any check did.
+ **/
+#define ILANG_CHECK(cond) do{\
+		if(!(cond)){\
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);\
+			++::ilang::tests::numFailures;\
+		}\
+	} while(0)
+
+//! Report a check failed unless evaluating \p expr throws a \c std::exception
+#define ILANG_CHECK_THROWS(expr) do{\
+		bool threw_ = false;\
+		try{ (void)(expr); }\
+		catch(const std::exception&){ threw_ = true; }\
+		ILANG_CHECK(threw_ && #expr);\
+	} while(0)
+
+namespace ilang::tests{
+	//! Number of failed checks so far
+	inline std::size_t numFailures = 0;
+
+	//! Exit status of a test executable
+	inline int result() noexcept{
+		if(numFailures)
+			std::fprintf(stderr, "%zu checks failed\n", numFailures);
+
+		return numFailures ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+}
+
+#endif // !ILANG_TESTS_CHECK_HPP
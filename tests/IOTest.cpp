@@ -0,0 +1,284 @@
+#include <string>
+#include <vector>
+
+#include "ilang/TypeIO.hpp"
+#include "ilang/TypeMangling.hpp"
+
+#include "../bench/BenchTypes.hpp"
+#include "Check.hpp"
+#include "TempFile.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Types of every kind with records: sized numbers past the prelude, strings of each encoding, partials and compounds of them
+	void buildTypes(TypeData &data){
+		for(std::uint32_t numBits : {3u, 24u, 512u}){
+			getComplexType(data, numBits);
+			getRationalType(data, numBits);
+			getNaturalType(data, numBits);
+		}
+
+		bench::TypeMix mix;
+		mix.allLeaves = true;
+		mix.partials = true;
+		mix.allKinds = true;
+		mix.wide = true;
+
+		auto types = bench::buildTypes(data, 250, mix);
+
+		getPartialType(data);
+		getListType(data, getPartialType(data));
+
+		data.typeAliases["Pair"] = getProductType(data, {data.realType, data.realType});
+		data.typeAliases["Text"] = getStringType(data, StringEncoding::ascii);
+		data.typeAliases["Last"] = types.back();
+	}
+
+	//! Check \p read has the types and aliases of \p data under the same ids and names
+	void checkSameTypes(const TypeData &data, const TypeData &read){
+		ILANG_CHECK(read.storage.size() == data.storage.size());
+		if(read.storage.size() != data.storage.size())
+			return;
+
+		for(std::size_t id = 0; id < data.storage.size(); id++){
+			auto type = data.storage[id], readType = read.storage[id];
+
+			ILANG_CHECK(readType->id == id);
+			ILANG_CHECK(readType->kind == type->kind);
+			ILANG_CHECK(readType->param == type->param);
+			ILANG_CHECK(getMangledName(read, readType) == getMangledName(data, type).view());
+			ILANG_CHECK(getTypeName(read, readType) == getTypeName(data, type).view());
+
+			if(type->kind != TypeKind::partial)
+				ILANG_CHECK(findDemangledType(read, getMangledName(read, readType)) == readType);
+		}
+
+		ILANG_CHECK(read.typeAliases.size() == data.typeAliases.size());
+
+		for(auto &&alias : data.typeAliases){
+			auto it = read.typeAliases.find(alias.first);
+			ILANG_CHECK(it != read.typeAliases.end() && it->second->id == alias.second->id);
+		}
+	}
+
+	void testRoundTrip(bool lazyNames, bool concurrent){
+		TypeDataOptions options;
+		options.lazyNames = lazyNames;
+		options.concurrent = concurrent;
+
+		TypeData data(options);
+		buildTypes(data);
+
+		tests::TempFile file;
+		writeTypeData(data, file.fd);
+		file.rewind();
+
+		auto read = readTypeData(file.fd, options);
+		checkSameTypes(data, read);
+
+		// types created after reading get the ids they get in the written data
+		auto last = data.storage.size() - 1;
+		ILANG_CHECK(getListType(read, read.storage[last])->id == getListType(data, data.storage[last])->id);
+		ILANG_CHECK(read.storage.size() == data.storage.size());
+	}
+
+	void testRecords(){
+		TypeData data;
+		buildTypes(data);
+
+		tests::TempFile file;
+
+		{
+			FileWriter writer(file.fd, 64);
+			for(auto id = data.numPreludeTypes; id < data.storage.size(); id++)
+				writeTypeRecord(writer, data.storage[id]);
+
+			writer.flush();
+		}
+
+		TypeData read;
+
+		{
+			file.rewind();
+
+			FileReader reader(file.fd, 64);
+			while(!reader.atEnd())
+				readTypeRecord(reader, read);
+		}
+
+		ILANG_CHECK(read.storage.size() == data.storage.size());
+
+		{
+			file.rewind();
+
+			FileReader reader(file.fd, 64);
+			for(auto id = data.numPreludeTypes; id < data.storage.size(); id++)
+				ILANG_CHECK(matchTypeRecord(reader, data, data.storage[id]));
+
+			ILANG_CHECK(reader.atEnd());
+		}
+
+		{
+			file.rewind();
+
+			// every record matched against the type after it, only partial types are alike
+			FileReader reader(file.fd, 64);
+			for(auto id = data.numPreludeTypes + 1; id < data.storage.size(); id++){
+				if(matchTypeRecord(reader, data, data.storage[id]))
+					ILANG_CHECK(data.storage[id]->kind == TypeKind::partial);
+			}
+		}
+
+		FileWriter writer(file.fd);
+		ILANG_CHECK_THROWS(writeTypeRecord(writer, data.realType));
+	}
+
+	//! Whether the records written by \p write are rejected as malformed
+	template<typename Write>
+	bool rejectsRecord(Write &&write){
+		tests::TempFile file;
+
+		{
+			FileWriter writer(file.fd);
+			write(writer);
+			writer.flush();
+		}
+
+		file.rewind();
+
+		TypeData data;
+		FileReader reader(file.fd);
+
+		try{
+			do readTypeRecord(reader, data);
+			while(!reader.atEnd());
+		}
+		catch(const std::exception&){
+			return true;
+		}
+
+		return false;
+	}
+
+	void testMalformedRecords(){
+		TypeData data;
+		auto realId = data.realType->id, unitId = data.unitType->id;
+		auto nextId = data.storage.size();
+
+		auto kindByte = [](TypeKind kind){ return static_cast<std::uint8_t>(kind); };
+
+		ILANG_CHECK(rejectsRecord([](FileWriter&){}));
+		ILANG_CHECK(rejectsRecord([](FileWriter &w){ w.writeByte(0xff); }));
+		ILANG_CHECK(rejectsRecord([&](FileWriter &w){ w.writeByte(kindByte(TypeKind::root)); }));
+
+		// inner types must already exist
+		ILANG_CHECK(rejectsRecord([&](FileWriter &w){ w.writeByte(kindByte(TypeKind::list)); w.writeVarint(nextId); }));
+		ILANG_CHECK(rejectsRecord([&](FileWriter &w){
+			w.writeByte(kindByte(TypeKind::sum));
+			w.writeVarint(2);
+			w.writeVarint(realId);
+			w.writeVarint(1u << 30);
+		}));
+
+		// a truncated record
+		ILANG_CHECK(rejectsRecord([&](FileWriter &w){
+			w.writeByte(kindByte(TypeKind::product));
+			w.writeVarint(3);
+			w.writeVarint(realId);
+		}));
+
+		ILANG_CHECK(rejectsRecord([&](FileWriter &w){
+			w.writeByte(kindByte(TypeKind::function));
+			w.writeVarint(std::uint64_t(1) << 40);
+		}));
+
+		ILANG_CHECK(rejectsRecord([&](FileWriter &w){ w.writeByte(kindByte(TypeKind::string)); w.writeVarint(7); }));
+
+		// sized numbers need a number base and some bits
+		ILANG_CHECK(rejectsRecord([&](FileWriter &w){
+			w.writeByte(kindByte(TypeKind::sizedNumber));
+			w.writeVarint(unitId);
+			w.writeVarint(32);
+		}));
+
+		ILANG_CHECK(rejectsRecord([&](FileWriter &w){
+			w.writeByte(kindByte(TypeKind::sizedNumber));
+			w.writeVarint(realId);
+			w.writeVarint(0);
+		}));
+
+		// a type that already exists was not created by its record
+		ILANG_CHECK(rejectsRecord([&](FileWriter &w){
+			for(int i = 0; i < 2; i++){
+				w.writeByte(kindByte(TypeKind::list));
+				w.writeVarint(realId);
+			}
+		}));
+
+		ILANG_CHECK(rejectsRecord([](FileWriter &w){
+			for(int i = 0; i < 10; i++)
+				w.writeByte(0xff);
+		}));
+	}
+
+	void testMalformedData(){
+		TypeData data;
+		buildTypes(data);
+
+		tests::TempFile file;
+		writeTypeData(data, file.fd);
+
+		auto bytes = file.contents();
+
+		// every truncation is rejected, none reads as less data
+		for(std::size_t len = 0; len < bytes.size(); len++){
+			file.assign(bytes.substr(0, len));
+			ILANG_CHECK_THROWS(readTypeData(file.fd));
+		}
+
+		std::size_t versionOffset = 4, hashOffset;
+
+		{
+			file.assign(bytes);
+
+			FileReader reader(file.fd);
+			char magic[4];
+			reader.read(magic, sizeof(magic));
+			reader.readVarint();
+			reader.readVarint();
+
+			hashOffset = static_cast<std::size_t>(reader.offset());
+		}
+
+		auto corrupt = [&](std::size_t offset, std::uint8_t mask){
+			auto corrupted = bytes;
+			corrupted[offset] = static_cast<char>(corrupted[offset] ^ mask);
+
+			file.assign(corrupted);
+			ILANG_CHECK_THROWS(readTypeData(file.fd));
+		};
+
+		corrupt(0, 0x20);
+		corrupt(versionOffset, 0x02);
+		corrupt(versionOffset + 1, 0x01);
+		corrupt(hashOffset, 0x01);
+		corrupt(hashOffset + 3, 0x10);
+
+		// and the data reads back once it is whole again
+		file.assign(bytes);
+		checkSameTypes(data, readTypeData(file.fd));
+	}
+}
+
+int main(){
+	for(bool lazyNames : {false, true}){
+		for(bool concurrent : {false, true})
+			testRoundTrip(lazyNames, concurrent);
+	}
+
+	testRecords();
+	testMalformedRecords();
+	testMalformedData();
+	return tests::result();
+}
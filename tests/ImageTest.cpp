@@ -0,0 +1,193 @@
+#include <string>
+#include <vector>
+
+#include "ilang/TypeImage.hpp"
+
+#include "../bench/BenchTypes.hpp"
+#include "Check.hpp"
+#include "TempFile.hpp"
+
+using namespace ilang;
+
+namespace {
+	constexpr std::uint32_t numBitsTried[] = {0, 1, 7, 8, 12, 16, 32, 64, 128, 256};
+
+	//! Id of \p type in the image, which keeps the ids of the data
+	TypeId idOf(TypeHandle type) noexcept{ return type ? type->id : invalidTypeId; }
+
+	//! Sized numbers of every family past the prelude and compound types of them
+	std::vector<TypeHandle> buildTypes(TypeData &data){
+		std::vector<TypeHandle> types;
+
+		for(std::uint32_t numBits : {1u, 8u, 12u, 24u, 128u, 256u}){
+			types.emplace_back(getComplexType(data, numBits));
+			types.emplace_back(getImaginaryType(data, numBits));
+			types.emplace_back(getRealType(data, numBits));
+			types.emplace_back(getRationalType(data, numBits));
+			types.emplace_back(getIntegerType(data, numBits));
+			types.emplace_back(getNaturalType(data, numBits));
+			types.emplace_back(getBooleanType(data, numBits));
+		}
+
+		bench::TypeMix mix;
+		mix.allLeaves = true;
+		mix.partials = true;
+		mix.allKinds = true;
+
+		auto compound = bench::buildTypes(data, 150, mix);
+		types.insert(end(types), begin(compound), end(compound));
+
+		data.typeAliases["Pair"] = getProductType(data, {data.realType, data.realType});
+		return types;
+	}
+
+	//! Check every query on \p image against the same query on \p data
+	void checkImage(const TypeData &data, const TypeImage &image){
+		auto n = data.storage.size();
+		ILANG_CHECK(image.numTypes() == n);
+
+		for(std::size_t id = 0; id < n; id++){
+			auto type = data.storage[id];
+			auto typeId = static_cast<TypeId>(id);
+
+			auto name = getTypeName(data, type);
+			auto mangled = getMangledName(data, type);
+
+			ILANG_CHECK(getTypeName(image, typeId) == name.view());
+			ILANG_CHECK(getMangledName(image, typeId) == mangled.view());
+			ILANG_CHECK(findTypeByString(image, name) == idOf(findTypeByString(data, name)));
+			ILANG_CHECK(findTypeByMangled(image, mangled) == idOf(findTypeByMangled(data, mangled)));
+
+			ILANG_CHECK(findTreeType(image, typeId) == idOf(findTreeType(data, type)));
+			ILANG_CHECK(findListType(image, typeId) == idOf(findListType(data, type)));
+			ILANG_CHECK(findArrayType(image, typeId) == idOf(findArrayType(data, type)));
+			ILANG_CHECK(findDynamicArrayType(image, typeId) == idOf(findDynamicArrayType(data, type)));
+
+			for(std::size_t len : {std::size_t(4), id, id + 1})
+				ILANG_CHECK(findStaticArrayType(image, typeId, len) == idOf(findStaticArrayType(data, type, len)));
+
+			for(std::size_t other = 0; other < n; other++){
+				auto otherId = static_cast<TypeId>(other);
+
+				ILANG_CHECK(hasBaseType(image, typeId, otherId) == hasBaseType(data, typeId, otherId));
+				ILANG_CHECK(findCommonType(image, typeId, otherId) == findCommonType(data, typeId, otherId));
+			}
+
+			// compound types are found by their own inner types, and only those are worth asking about
+			if(id % 3 == 0){
+				auto other = data.storage[(id * 7 + 1) % n];
+				auto otherId = other->id;
+
+				ILANG_CHECK(findSumType(image, {typeId, otherId}) == idOf(findSumType(data, {type, other})));
+				ILANG_CHECK(findProductType(image, {otherId, typeId}) == idOf(findProductType(data, {other, type})));
+				ILANG_CHECK(findFunctionType(image, {typeId}, otherId) == idOf(findFunctionType(data, {type}, other)));
+			}
+
+			if(isCompoundType(type)){
+				std::vector<TypeId> inner;
+				std::vector<TypeHandle> innerTypes(begin(type->types), end(type->types));
+
+				for(auto t : innerTypes)
+					inner.emplace_back(t->id);
+
+				switch(type->kind){
+					case TypeKind::sum: ILANG_CHECK(findSumType(image, inner) == typeId); break;
+					case TypeKind::product: ILANG_CHECK(findProductType(image, inner) == typeId); break;
+
+					case TypeKind::function:{
+						auto result = inner.back();
+						inner.pop_back();
+						ILANG_CHECK(findFunctionType(image, inner, result) == typeId);
+						break;
+					}
+
+					default: break;
+				}
+			}
+		}
+
+		for(auto numBits : numBitsTried){
+			ILANG_CHECK(findComplexType(image, numBits) == idOf(findComplexType(data, numBits)));
+			ILANG_CHECK(findImaginaryType(image, numBits) == idOf(findImaginaryType(data, numBits)));
+			ILANG_CHECK(findRealType(image, numBits) == idOf(findRealType(data, numBits)));
+			ILANG_CHECK(findRationalType(image, numBits) == idOf(findRationalType(data, numBits)));
+			ILANG_CHECK(findIntegerType(image, numBits) == idOf(findIntegerType(data, numBits)));
+			ILANG_CHECK(findNaturalType(image, numBits) == idOf(findNaturalType(data, numBits)));
+			ILANG_CHECK(findBooleanType(image, numBits) == idOf(findBooleanType(data, numBits)));
+		}
+
+		for(auto &&alias : data.typeAliases)
+			ILANG_CHECK(findTypeByString(image, alias.first) == alias.second->id);
+
+		for(auto str : {"", "Foo", "Real7", "(List Foo)"})
+			ILANG_CHECK(findTypeByString(image, str) == idOf(findTypeByString(data, str)));
+	}
+
+	//! Write an image of \p data and check it against \p data, mapped and in memory
+	void testImage(const TypeData &data){
+		tests::TempFile file;
+		writeTypeImage(data, file.fd);
+
+		checkImage(data, TypeImage::map(file.path.c_str()));
+
+		auto size = static_cast<std::size_t>(file.size());
+		std::vector<std::uint64_t> bytes((size + 7) / 8);
+
+		file.rewind();
+		ILANG_CHECK(::read(file.fd, bytes.data(), size) == static_cast<ssize_t>(size));
+
+		checkImage(data, TypeImage(bytes.data(), size));
+	}
+
+	void testPrelude(){
+		TypeData data;
+		testImage(data);
+
+		// sized numbers of the prelude are refined from each other, but keyed by their own family
+		tests::TempFile file;
+		writeTypeImage(data, file.fd);
+
+		auto image = TypeImage::map(file.path.c_str());
+		ILANG_CHECK(findRationalType(image, 128) == findRationalType(data, 128)->id);
+		ILANG_CHECK(findRealType(image, 128) == invalidTypeId);
+	}
+
+	void testTypes(){
+		TypeData data;
+		buildTypes(data);
+		testImage(data);
+	}
+
+	void testLazyTypes(){
+		TypeDataOptions options;
+		options.lazyNames = true;
+
+		TypeData data(options);
+		buildTypes(data);
+		testImage(data);
+	}
+
+	void testConcurrentTypes(){
+		TypeDataOptions options;
+		options.concurrent = true;
+
+		TypeData data(options);
+		buildTypes(data);
+		testImage(data);
+	}
+
+	void testMalformed(){
+		std::vector<std::uint64_t> bytes(64);
+		ILANG_CHECK_THROWS(TypeImage(bytes.data(), bytes.size() * 8));
+		ILANG_CHECK_THROWS(TypeImage(bytes.data(), 3));
+	}
+}
+
+int main(){
+	testPrelude();
+	testTypes();
+	testLazyTypes();
+	testConcurrentTypes();
+	testMalformed();
+	return tests::result();
+}
@@ -0,0 +1,179 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ilang/TypeJournal.hpp"
+
+#include "Check.hpp"
+#include "TempFile.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Create \p n more types in \p data, different ones for each \p seed
+	void addTypes(TypeData &data, std::size_t n, std::size_t seed = 0){
+		auto first = data.storage.size();
+		for(std::size_t i = 0; data.storage.size() < first + n; i++)
+			getStaticArrayType(data, data.realType, seed * 1000000 + first + i);
+	}
+
+	//! Whether \p lhs and \p rhs have the same types under the same ids
+	bool sameTypes(const TypeData &lhs, const TypeData &rhs){
+		if(lhs.storage.size() != rhs.storage.size())
+			return false;
+
+		for(std::size_t id = 0; id < lhs.storage.size(); id++){
+			if(getMangledName(lhs, lhs.storage[id]) != getMangledName(rhs, rhs.storage[id]).view())
+				return false;
+		}
+
+		return true;
+	}
+
+	TypeData readSnapshot(const tests::TempFile &file){
+		file.rewind();
+		return readTypeData(file.fd);
+	}
+
+	void testReplay(){
+		tests::TempFile journalFile;
+
+		TypeData data;
+		TypeJournal journal(data, journalFile.fd);
+
+		addTypes(data, 10);
+		ILANG_CHECK(writeJournal(journal) == 10);
+		ILANG_CHECK(writeJournal(journal) == 0);
+
+		addTypes(data, 5);
+		ILANG_CHECK(writeJournal(journal, true) == 5);
+
+		TypeData replayed;
+		TypeJournal reopened(replayed, journalFile.fd);
+
+		ILANG_CHECK(reopened.numReplayed == 15);
+		ILANG_CHECK(sameTypes(data, replayed));
+	}
+
+	void testTornRecord(){
+		tests::TempFile journalFile;
+
+		TypeData data;
+		TypeJournal journal(data, journalFile.fd);
+
+		addTypes(data, 3);
+		writeJournal(journal);
+
+		auto size = journalFile.size();
+		journalFile.truncate(size - 1);
+
+		TypeData replayed;
+		TypeJournal reopened(replayed, journalFile.fd);
+
+		ILANG_CHECK(reopened.numReplayed == data.storage.size() - data.numPreludeTypes - 1);
+		ILANG_CHECK(replayed.storage.size() == data.storage.size() - 1);
+		ILANG_CHECK(journalFile.size() < size - 1);
+	}
+
+	void testCompact(){
+		tests::TempFile journalFile, snapshotFile;
+
+		TypeData data;
+		TypeJournal journal(data, journalFile.fd);
+
+		addTypes(data, 10);
+		writeJournal(journal);
+
+		// a commit that fails leaves the journal as is
+		ILANG_CHECK_THROWS(compactJournal(journal, snapshotFile.fd, []{ throw std::runtime_error("commit failed"); }));
+		ILANG_CHECK(journal.numBaseTypes == data.numPreludeTypes);
+
+		snapshotFile.truncate(0);
+
+		bool committed = false;
+		compactJournal(journal, snapshotFile.fd, [&]{ committed = true; });
+
+		ILANG_CHECK(committed);
+		ILANG_CHECK(journal.numBaseTypes == data.storage.size());
+
+		addTypes(data, 4);
+		writeJournal(journal);
+
+		auto restored = readSnapshot(snapshotFile);
+		TypeJournal reopened(restored, journalFile.fd);
+
+		ILANG_CHECK(reopened.numReplayed == 4);
+		ILANG_CHECK(sameTypes(data, restored));
+	}
+
+	void testCrashBeforeRestart(){
+		tests::TempFile journalFile, snapshotFile;
+
+		TypeData data;
+		TypeJournal journal(data, journalFile.fd);
+
+		addTypes(data, 10);
+		writeJournal(journal);
+
+		// the snapshot may hold types the journal does not have yet
+		addTypes(data, 3);
+		writeJournalSnapshot(journal, snapshotFile.fd);
+
+		auto restored = readSnapshot(snapshotFile);
+		TypeJournal reopened(restored, journalFile.fd);
+
+		ILANG_CHECK(reopened.numBaseTypes == data.storage.size());
+		ILANG_CHECK(sameTypes(data, restored));
+	}
+
+	void testOlderSnapshot(){
+		tests::TempFile journalFile, snapshotFile;
+
+		TypeData data;
+		TypeJournal journal(data, journalFile.fd);
+
+		addTypes(data, 10);
+		writeJournal(journal);
+		writeJournalSnapshot(journal, snapshotFile.fd);
+
+		addTypes(data, 10);
+		writeJournal(journal);
+
+		// the journal has types the snapshot is missing, and must be kept for them
+		auto size = journalFile.size();
+		auto restored = readSnapshot(snapshotFile);
+
+		ILANG_CHECK_THROWS(TypeJournal(restored, journalFile.fd));
+		ILANG_CHECK(journalFile.size() == size);
+	}
+
+	void testOtherSnapshot(){
+		tests::TempFile journalFile, snapshotFile;
+
+		TypeData data;
+		TypeJournal journal(data, journalFile.fd);
+
+		addTypes(data, 10);
+		writeJournal(journal);
+
+		TypeData other;
+		addTypes(other, 20, 1);
+		writeTypeData(other, snapshotFile.fd);
+
+		auto size = journalFile.size();
+		auto restored = readSnapshot(snapshotFile);
+
+		ILANG_CHECK_THROWS(TypeJournal(restored, journalFile.fd));
+		ILANG_CHECK(journalFile.size() == size);
+	}
+}
+
+int main(){
+	testReplay();
+	testTornRecord();
+	testCompact();
+	testCrashBeforeRestart();
+	testOlderSnapshot();
+	testOtherSnapshot();
+	return tests::result();
+}
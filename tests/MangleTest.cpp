@@ -0,0 +1,90 @@
+#include <string>
+#include <vector>
+
+#include "ilang/TypeMangling.hpp"
+
+#include "../bench/BenchTypes.hpp"
+#include "Check.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Types of every kind, nested a few levels deep; partial types are only created fresh, so they are optional
+	std::vector<TypeHandle> buildTypes(TypeData &data, bool partials = true){
+		bench::TypeMix mix;
+		mix.allLeaves = true;
+		mix.partials = partials;
+		mix.allKinds = true;
+		mix.wide = true;
+		return bench::buildTypes(data, 250, mix);
+	}
+
+	void testRoundTrip(){
+		TypeData data;
+
+		for(auto type : buildTypes(data)){
+			auto mangled = getMangledName(data, type);
+
+			ILANG_CHECK(findDemangledType(data, mangled) == type);
+			ILANG_CHECK(getDemangledType(data, mangled) == type);
+		}
+	}
+
+	void testLazyRoundTrip(){
+		TypeDataOptions options;
+		options.lazyNames = true;
+
+		TypeData data(options);
+
+		for(auto type : buildTypes(data))
+			ILANG_CHECK(findDemangledType(data, getMangledName(data, type)) == type);
+	}
+
+	void testGetCreatesTypes(){
+		std::vector<std::string> names;
+
+		{
+			TypeData data;
+			for(auto type : buildTypes(data, false))
+				names.emplace_back(getMangledName(data, type));
+		}
+
+		TypeData data;
+
+		for(auto &&mangled : names){
+			auto type = getDemangledType(data, mangled);
+
+			ILANG_CHECK(type != nullptr);
+			ILANG_CHECK(type && getMangledName(data, type) == mangled);
+			ILANG_CHECK(findDemangledType(data, mangled) == type);
+		}
+	}
+
+	void testFindDoesNotCreate(){
+		TypeData data;
+		auto numTypes = data.storage.size();
+
+		ILANG_CHECK(findDemangledType(data, "ol0r64") == nullptr);
+		ILANG_CHECK(findDemangledType(data, "u2n8z32") == nullptr);
+		ILANG_CHECK(findDemangledType(data, "f1p0r?") == nullptr);
+		ILANG_CHECK(data.storage.size() == numTypes);
+	}
+
+	void testMalformed(){
+		TypeData data;
+
+		for(auto mangled : {"", "?", "???", "x", "r", "r0x", "a", "a3", "ol0", "ol1r?", "p1r?", "u2r?", "f1r?", "_", "r?r?"}){
+			ILANG_CHECK(findDemangledType(data, mangled) == nullptr);
+			ILANG_CHECK(getDemangledType(data, mangled) == nullptr);
+		}
+	}
+}
+
+int main(){
+	testRoundTrip();
+	testLazyRoundTrip();
+	testGetCreatesTypes();
+	testFindDoesNotCreate();
+	testMalformed();
+	return tests::result();
+}
@@ -0,0 +1,80 @@
+#include <thread>
+#include <vector>
+
+#include "ilang/Type.hpp"
+
+#include "Check.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Check the running totals of \p data against a walk of every type
+	void checkTotals(const TypeData &data){
+		auto report = getTypeMemoryReport(data);
+		auto walked = getTypeMemoryReport(data, true);
+
+		for(std::size_t i = 0; i < numTypeKinds; i++){
+			ILANG_CHECK(report.kinds[i].numTypes == walked.kinds[i].numTypes);
+			ILANG_CHECK(report.kinds[i].innerTypeBytes == walked.kinds[i].innerTypeBytes);
+			ILANG_CHECK(report.kinds[i].nameBytes == walked.kinds[i].nameBytes);
+		}
+
+		ILANG_CHECK(report.totalBytes == walked.totalBytes);
+	}
+
+	//! Types of every kind, names of some of them rendered
+	void buildTypes(TypeData &data, std::size_t seed = 0){
+		for(std::size_t i = 0; i < 200; i++){
+			auto n = seed * 1000 + i;
+			auto array = getStaticArrayType(data, data.realType, n);
+
+			if(i % 5 == 0) getTypeName(data, getListType(data, array));
+			if(i % 7 == 0) getMangledName(data, getFunctionType(data, {array}, data.unitType));
+			if(i % 11 == 0) getSumType(data, {array, getIntegerType(data, static_cast<std::uint32_t>(n % 64 + 1))});
+		}
+
+		getPartialType(data);
+		getStringType(data, StringEncoding::utf8);
+	}
+
+	void testModes(){
+		for(int mode = 0; mode < 4; mode++){
+			TypeDataOptions options;
+			options.lazyNames = mode & 1;
+			options.concurrent = mode & 2;
+
+			TypeData data(options);
+			checkTotals(data);
+
+			buildTypes(data);
+			checkTotals(data);
+
+			// rendering lazy names on lookup adds their bytes
+			findTypeByString(data, "Real");
+			checkTotals(data);
+		}
+	}
+
+	void testThreads(){
+		TypeDataOptions options;
+		options.concurrent = true;
+		options.lazyNames = true;
+
+		TypeData data(options);
+		std::vector<std::thread> threads;
+
+		for(std::size_t i = 0; i < 4; i++)
+			threads.emplace_back([&data, i]{ buildTypes(data, i % 2); });
+
+		for(auto &&thread : threads)
+			thread.join();
+
+		checkTotals(data);
+	}
+}
+
+int main(){
+	testModes();
+	testThreads();
+	return tests::result();
+}
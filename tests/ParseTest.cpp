@@ -0,0 +1,136 @@
+#include <string>
+#include <vector>
+
+#include "ilang/TypeParsing.hpp"
+
+#include "../bench/BenchTypes.hpp"
+#include "Check.hpp"
+
+using namespace ilang;
+
+namespace {
+	void testPrecedence(){
+		TypeData data;
+
+		auto real = data.realType, integer = data.integerType, natural = data.naturalType, boolean = data.booleanType;
+
+		// '*' binds tighter than '|', which binds tighter than '->'
+		auto product = getProductType(data, {real, integer});
+		auto sum = getSumType(data, {product, natural});
+		auto function = getFunctionType(data, {sum}, boolean);
+
+		ILANG_CHECK(findParsedType(data, "Real * Integer") == product);
+		ILANG_CHECK(findParsedType(data, "Real * Integer | Natural") == sum);
+		ILANG_CHECK(findParsedType(data, "Natural | Real * Integer") == sum);
+		ILANG_CHECK(findParsedType(data, "Real * Integer | Natural -> Boolean") == function);
+
+		// every arrow but the last separates parameters
+		auto binary = getFunctionType(data, {real, integer}, boolean);
+		ILANG_CHECK(findParsedType(data, "Real -> Integer -> Boolean") == binary);
+
+		// parentheses group
+		auto grouped = getProductType(data, {real, getSumType(data, {integer, natural})});
+		ILANG_CHECK(findParsedType(data, "Real * (Integer | Natural)") == grouped);
+		ILANG_CHECK(findParsedType(data, "((Real) * ((Integer | Natural)))") == grouped);
+
+		auto nested = getFunctionType(data, {getFunctionType(data, {real}, integer)}, boolean);
+		ILANG_CHECK(findParsedType(data, "(Real -> Integer) -> Boolean") == nested);
+
+		ILANG_CHECK(getParsedType(data, "Boolean * Natural | Unit -> Real") == getFunctionType(data, {getSumType(data, {getProductType(data, {boolean, natural}), data.unitType})}, real));
+	}
+
+	void testObjects(){
+		TypeData data;
+
+		auto list = getListType(data, data.realType);
+
+		ILANG_CHECK(getParsedType(data, "(List Real)") == list);
+		ILANG_CHECK(getParsedType(data, "(Tree Real)") == getTreeType(data, data.realType));
+		ILANG_CHECK(getParsedType(data, "(Array (List Real))") == getArrayType(data, list));
+		ILANG_CHECK(getParsedType(data, "(DynamicArray Real | Natural)") == getDynamicArrayType(data, getSumType(data, {data.realType, data.naturalType})));
+		ILANG_CHECK(getParsedType(data, "(StaticArray Integer 4)") == getStaticArrayType(data, data.integerType, 4));
+		ILANG_CHECK(getParsedType(data, " ( List\tReal ) ") == list);
+	}
+
+	void testAliases(){
+		TypeData data;
+
+		ILANG_CHECK(findParsedType(data, "Int") == data.integerType);
+		ILANG_CHECK(findParsedType(data, "Nat") == data.naturalType);
+		ILANG_CHECK(findParsedType(data, "Bool") == data.booleanType);
+		ILANG_CHECK(findParsedType(data, "Ratio") == data.rationalType);
+		ILANG_CHECK(findParsedType(data, "Ratio64") == findRationalType(data, 64));
+
+		ILANG_CHECK(getParsedType(data, "Int * Nat -> Bool") == getFunctionType(data, {getProductType(data, {data.integerType, data.naturalType})}, data.booleanType));
+		ILANG_CHECK(getParsedType(data, "(List Int)") == getListType(data, data.integerType));
+	}
+
+	void testSizedNames(){
+		TypeData data;
+
+		ILANG_CHECK(findParsedType(data, "Real64") == findRealType(data, 64));
+		ILANG_CHECK(findParsedType(data, "Rational128") == findRationalType(data, 128));
+
+		// sized names of families and of their aliases
+		ILANG_CHECK(getParsedType(data, "Integer32") == getIntegerType(data, 32));
+		ILANG_CHECK(getParsedType(data, "Int12") == getIntegerType(data, 12));
+		ILANG_CHECK(getParsedType(data, "Nat8") == getNaturalType(data, 8));
+		ILANG_CHECK(getParsedType(data, "Bool1") == getBooleanType(data, 1));
+		ILANG_CHECK(getParsedType(data, "Complex256") == getComplexType(data, 256));
+		ILANG_CHECK(getParsedType(data, "Imaginary16") == getImaginaryType(data, 16));
+
+		ILANG_CHECK(getParsedType(data, "AsciiString") == getStringType(data, StringEncoding::ascii));
+		ILANG_CHECK(getParsedType(data, "Utf8String") == getStringType(data, StringEncoding::utf8));
+
+		// no size, leading zeros and unknown families
+		for(auto str : {"Integer0", "Int012", "Foo32", "Unit8", "Integer99999999999"})
+			ILANG_CHECK(getParsedType(data, str) == nullptr);
+	}
+
+	void testRoundTrip(){
+		TypeData data;
+
+		bench::TypeMix mix;
+		mix.allKinds = true;
+		mix.parseable = true;
+
+		for(auto type : bench::buildTypes(data, 200, mix)){
+			auto name = getTypeName(data, type);
+			ILANG_CHECK(findParsedType(data, name) == type);
+			ILANG_CHECK(getParsedType(data, name) == type);
+		}
+	}
+
+	void testFindDoesNotCreate(){
+		TypeData data;
+		auto numTypes = data.storage.size();
+
+		ILANG_CHECK(findParsedType(data, "(List Real)") == nullptr);
+		ILANG_CHECK(findParsedType(data, "Integer7") == nullptr);
+		ILANG_CHECK(findParsedType(data, "Real * Natural") == nullptr);
+		ILANG_CHECK(data.storage.size() == numTypes);
+	}
+
+	void testMalformed(){
+		TypeData data;
+
+		for(auto str : {"", "Foo", "Real *", "| Real", "Real ->", "(Real", "Real)", "(List)", "(StaticArray Real)", "(StaticArray Real 01)", "Real Real"}){
+			ILANG_CHECK(findParsedType(data, str) == nullptr);
+			ILANG_CHECK(getParsedType(data, str) == nullptr);
+		}
+
+		// nesting deeper than the parser allows
+		ILANG_CHECK(getParsedType(data, std::string(1000, '(') + "Real" + std::string(1000, ')')) == nullptr);
+	}
+}
+
+int main(){
+	testPrecedence();
+	testObjects();
+	testAliases();
+	testSizedNames();
+	testRoundTrip();
+	testFindDoesNotCreate();
+	testMalformed();
+	return tests::result();
+}
@@ -0,0 +1,145 @@
+#include <string>
+#include <vector>
+
+#include "ilang/TypeIO.hpp"
+#include "ilang/TypeMangling.hpp"
+#include "ilang/TypeParsing.hpp"
+#include "ilang/TypeRecording.hpp"
+
+#include "Check.hpp"
+#include "TempFile.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Make calls of most kinds on \p data, finds that miss as well as ones that hit
+	void makeCalls(TypeData &data){
+		auto i32 = getIntegerType(data, 32);
+		auto utf8 = getStringType(data, StringEncoding::utf8);
+
+		for(std::size_t i = 0; i < 300; i++){
+			auto array = getStaticArrayType(data, i % 2 ? i32 : utf8, i);
+			auto list = getListType(data, array);
+
+			findTreeType(data, list);
+			findStaticArrayType(data, i32, i + 1);
+
+			auto sum = getSumType(data, {list, data.realType});
+			auto fn = getFunctionType(data, {sum, array}, list);
+
+			if(i % 10 == 0){
+				getTypeName(data, fn);
+				findDemangledType(data, getMangledName(data, sum));
+				findTypeByString(data, "(List Real)");
+				getParsedType(data, "Integer * Boolean -> Unit");
+				getPartialType(data);
+			}
+		}
+	}
+
+	//! Whether \p lhs and \p rhs have the same types under the same ids
+	bool sameTypes(const TypeData &lhs, const TypeData &rhs){
+		if(lhs.storage.size() != rhs.storage.size())
+			return false;
+
+		for(std::size_t id = 0; id < lhs.storage.size(); id++){
+			if(getMangledName(lhs, lhs.storage[id]) != getMangledName(rhs, rhs.storage[id]).view())
+				return false;
+		}
+
+		return true;
+	}
+
+	//! Record \p makeCalls on a data that already has some types, returns the number of calls recorded
+	std::uint64_t record(const tests::TempFile &file, TypeData &data){
+		getProductType(data, {data.realType, getNaturalType(data, 8)});
+		data.typeAliases["Pair"] = data.storage.back();
+
+		startTypeRecording(data, file.fd);
+		makeCalls(data);
+		return stopTypeRecording(data);
+	}
+
+	TypeWorkload readWorkload(const tests::TempFile &file){
+		file.rewind();
+		return readTypeWorkload(file.fd);
+	}
+
+	void testRoundTrip(){
+		tests::TempFile file;
+
+		TypeData recorded;
+		auto numRecorded = record(file, recorded);
+
+		auto workload = readWorkload(file);
+		ILANG_CHECK(workload.calls.size() == numRecorded);
+		ILANG_CHECK(workload.numSetupCalls > 0);
+
+		TypeData replayed;
+		auto res = replayTypeWorkload(workload, replayed);
+
+		ILANG_CHECK(res.numCalls == workload.calls.size() - workload.numSetupCalls);
+		ILANG_CHECK(res.numMismatches == 0);
+		ILANG_CHECK(sameTypes(recorded, replayed));
+		ILANG_CHECK(findTypeByString(replayed, "Pair") == getProductType(replayed, {replayed.realType, getNaturalType(replayed, 8)}));
+	}
+
+	void testTornCall(){
+		tests::TempFile file;
+
+		TypeData recorded;
+		auto numRecorded = record(file, recorded);
+
+		file.truncate(file.size() - 1);
+
+		auto workload = readWorkload(file);
+		ILANG_CHECK(workload.calls.size() == numRecorded - 1);
+
+		TypeData replayed;
+		ILANG_CHECK(replayTypeWorkload(workload, replayed).numMismatches == 0);
+	}
+
+	void testConcurrentReplay(){
+		tests::TempFile file;
+
+		TypeData recorded;
+		record(file, recorded);
+
+		auto workload = readWorkload(file);
+
+		TypeDataOptions options;
+		options.concurrent = true;
+
+		TypeReplayOptions replayOptions;
+		replayOptions.numThreads = 3;
+		replayOptions.callsPerChunk = 16;
+
+		// partitioned calls may find types before another thread created them, but every type is created
+		TypeData replayed(options);
+		auto res = replayTypeWorkload(workload, replayed, replayOptions);
+
+		ILANG_CHECK(res.numCalls == workload.calls.size() - workload.numSetupCalls);
+		ILANG_CHECK(replayed.storage.size() == recorded.storage.size());
+
+		TypeData single;
+		ILANG_CHECK_THROWS(replayTypeWorkload(workload, single, replayOptions));
+	}
+
+	void testMalformed(){
+		tests::TempFile file;
+		ILANG_CHECK_THROWS(readWorkload(file));
+
+		// type data is not a recording
+		TypeData data;
+		writeTypeData(data, file.fd);
+		ILANG_CHECK_THROWS(readWorkload(file));
+	}
+}
+
+int main(){
+	testRoundTrip();
+	testTornCall();
+	testConcurrentReplay();
+	testMalformed();
+	return tests::result();
+}
@@ -0,0 +1,69 @@
+#ifndef ILANG_TESTS_TEMPFILE_HPP
+#define ILANG_TESTS_TEMPFILE_HPP 1
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+namespace ilang::tests{
+	//! Empty file open for reading and writing, removed once the test is done with it
+	struct TempFile{
+		TempFile(){
+			char name[] = "/tmp/ilang-types-test-XXXXXX";
+
+			fd = ::mkstemp(name);
+			if(fd < 0)
+				throw std::runtime_error("creating a temporary file");
+
+			path = name;
+		}
+
+		~TempFile(){
+			::close(fd);
+			::unlink(path.c_str());
+		}
+
+		TempFile(const TempFile&) = delete;
+		TempFile &operator=(const TempFile&) = delete;
+
+		//! Seek back to the start, to read what was written
+		void rewind() const{ ::lseek(fd, 0, SEEK_SET); }
+
+		//! Truncate to \p size bytes and seek to the start
+		void truncate(off_t size) const{
+			if(::ftruncate(fd, size) != 0)
+				throw std::runtime_error("truncating a temporary file");
+
+			rewind();
+		}
+
+		//! Size of the file, leaves the offset at its end
+		off_t size() const{ return ::lseek(fd, 0, SEEK_END); }
+
+		//! Every byte of the file, leaves the offset at its start
+		std::string contents() const{
+			std::string bytes(static_cast<std::size_t>(size()), '\0');
+
+			if(::pread(fd, bytes.data(), bytes.size(), 0) != static_cast<ssize_t>(bytes.size()))
+				throw std::runtime_error("reading a temporary file");
+
+			rewind();
+			return bytes;
+		}
+
+		//! Replace the file with \p bytes and seek to the start
+		void assign(const std::string &bytes) const{
+			truncate(0);
+
+			if(::pwrite(fd, bytes.data(), bytes.size(), 0) != static_cast<ssize_t>(bytes.size()))
+				throw std::runtime_error("writing a temporary file");
+		}
+
+		int fd;
+		std::string path;
+	};
+}
+
+#endif // !ILANG_TESTS_TEMPFILE_HPP
@@ -0,0 +1,100 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ilang/TypeTrace.hpp"
+
+#include "Check.hpp"
+#include "TempFile.hpp"
+
+using namespace ilang;
+
+namespace {
+	//! Record \p n operations on a thread of its own and wait for it to exit
+	void recordOnThread(std::size_t n){
+		std::thread thread([n]{
+			for(std::size_t i = 0; i < n; i++)
+				recordTypeTraceEvent("test", typeTraceClock());
+		});
+
+		thread.join();
+	}
+
+	//! Number of operations of the trace written to \p file with thread id \p tid
+	std::size_t countTid(const tests::TempFile &file, unsigned tid){
+		auto contents = file.contents();
+		auto needle = "\"tid\":" + std::to_string(tid) + ",";
+
+		std::size_t n = 0;
+		for(auto pos = contents.find(needle); pos != std::string::npos; pos = contents.find(needle, pos + 1))
+			++n;
+
+		return n;
+	}
+
+	void testExitedThreadsReuseRings(){
+		tests::TempFile file;
+
+		TypeTraceOptions options;
+		options.eventsPerThread = 64;
+		startTypeTrace(options);
+
+		for(int i = 0; i < 20; i++)
+			recordOnThread(2);
+
+		// every thread got the ring of the one before and kept its operations
+		ILANG_CHECK(writeTypeTrace(file.path.c_str()) == 40);
+		ILANG_CHECK(countTid(file, 0) == 40);
+		ILANG_CHECK(countTid(file, 1) == 0);
+
+		// threads alive at the same time need a ring each
+		std::vector<std::thread> threads;
+		std::atomic<int> numStarted{0};
+
+		for(int i = 0; i < 3; i++){
+			threads.emplace_back([&numStarted]{
+				recordTypeTraceEvent("test", typeTraceClock());
+
+				++numStarted;
+				while(numStarted.load() < 3)
+					std::this_thread::yield();
+			});
+		}
+
+		for(auto &&thread : threads)
+			thread.join();
+
+		ILANG_CHECK(writeTypeTrace(file.path.c_str()) == 43);
+		ILANG_CHECK(countTid(file, 1) == 1 && countTid(file, 2) == 1);
+		ILANG_CHECK(countTid(file, 3) == 0);
+
+		stopTypeTrace();
+	}
+
+	void testReusedRingsResize(){
+		tests::TempFile file;
+
+		TypeTraceOptions options;
+		options.eventsPerThread = 4;
+		startTypeTrace(options);
+
+		recordOnThread(10);
+
+		// the oldest kept operation may be being overwritten, so it is left out
+		ILANG_CHECK(writeTypeTrace(file.path.c_str()) == 3);
+
+		options.eventsPerThread = 1000;
+		startTypeTrace(options);
+
+		recordOnThread(100);
+		ILANG_CHECK(writeTypeTrace(file.path.c_str()) == 100);
+
+		stopTypeTrace();
+	}
+}
+
+int main(){
+	testExitedThreadsReuseRings();
+	testReusedRingsResize();
+	return tests::result();
+}